@@ -0,0 +1,179 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   binary_io.h
+
+    Classes for writing and reading simple binary files of fixed-size values and arrays.
+    Values are in native byte order; such files are intended to be read only on the machine that wrote them.
+*/
+
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include "macros.h"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// -----------  binary_writer  ----------------
+
+/*! \class  binary_writer
+    \brief  Accumulate binary values in a buffer
+*/
+
+class binary_writer
+{
+protected:
+
+  std::string _buffer { };      ///< the bytes written so far
+
+public:
+
+/*! \brief          Append a value
+    \param  value   value to append
+*/
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  inline void put(const T& value)
+    { _buffer.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+/*! \brief          Append an array of values, without its size
+    \param  values  values to append
+*/
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  inline void put(std::span<const T> values)
+    { _buffer.append(reinterpret_cast<const char*>(values.data()), values.size_bytes()); }
+
+/*! \brief          Append a string, without its size
+    \param  str     string to append
+*/
+  inline void put(const std::string_view str)
+    { _buffer.append(str); }
+
+/*! \brief              Append zero bytes until the size is a multiple of a particular value
+    \param  alignment   the value
+*/
+  inline void align(const size_t alignment)
+    { _buffer.append((alignment - _buffer.size() % alignment) % alignment, '\0'); }
+
+  READ(buffer);                 ///< the bytes written so far
+};
+
+// -----------  binary_reader  ----------------
+
+/*! \class  binary_reader
+    \brief  Read the binary values written by a binary_writer
+
+    Reading beyond the end of the data marks the reader as bad, and then returns default values and empty arrays.
+    Arrays are returned as views of the data, which must therefore be aligned at least as strictly as
+    the writer's calls to align() assume. A reader whose data are at the start of a memory-mapped file is suitable.
+*/
+
+class binary_reader
+{
+protected:
+
+  std::span<const char> _data;          ///< the data to be read
+  size_t                _posn { 0 };    ///< position of the next byte to be read
+  bool                  _good { true }; ///< whether all reads so far have succeeded
+
+/*! \brief          Reserve bytes to be read
+    \param  n_bytes number of bytes
+    \return         whether <i>n_bytes</i> bytes are available
+
+    Marks the reader as bad if the bytes are not available
+*/
+  inline bool _available(const size_t n_bytes)
+    { if (_good and (n_bytes > _data.size() - _posn))
+        _good = false;
+
+      return _good;
+    }
+
+public:
+
+/*! \brief          Constructor
+    \param  data    the data to be read
+*/
+  explicit binary_reader(std::span<const char> data) :
+    _data(data)
+  { }
+
+  READ(good);                           ///< whether all reads so far have succeeded
+
+/// read a value
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  T get(void)
+  { T rv { };
+
+    if (_available(sizeof(T)))
+    { std::memcpy(&rv, _data.data() + _posn, sizeof(T));
+      _posn += sizeof(T);
+    }
+
+    return rv;
+  }
+
+/*! \brief      Read an array of values
+    \param  n   number of values
+    \return     view of the values in the data
+*/
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  std::span<const T> get_span(const size_t n)
+  { if ( !_good or (n > (_data.size() - _posn) / sizeof(T)) or (reinterpret_cast<uintptr_t>(_data.data() + _posn) % alignof(T)) )
+    { _good = false;
+      return { };
+    }
+
+    const std::span<const T> rv { reinterpret_cast<const T*>(_data.data() + _posn), n };
+
+    _posn += n * sizeof(T);
+
+    return rv;
+  }
+
+/*! \brief      Read a string
+    \param  n   number of characters
+    \return     view of the string in the data
+*/
+  inline std::string_view get_string(const size_t n)
+  { if (!_available(n))
+      return { };
+
+    const std::string_view rv { _data.data() + _posn, n };
+
+    _posn += n;
+
+    return rv;
+  }
+
+/*! \brief              Skip bytes until the position is a multiple of a particular value
+    \param  alignment   the value
+*/
+  inline void align(const size_t alignment)
+  { const size_t n_bytes { (alignment - _posn % alignment) % alignment };
+
+    if (_available(n_bytes))
+      _posn += n_bytes;
+  }
+
+/// have all the data been read?
+  inline bool at_end(void) const
+    { return (_posn == _data.size()); }
+};
+
+#endif    // BINARY_IO_H
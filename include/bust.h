@@ -0,0 +1,225 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   bust.h
+
+    Functions and classes for recognising busted calls
+*/
+
+#ifndef BUST_H
+#define BUST_H
+
+#include "call_table.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/*  \brief          Is a copied call a bust of another call?
+    \param  call    target (correct) call
+    \param  copied  copied call
+    \return         whether <i>copied</i> is a plausible bust of <i>call</i>
+    
+    A bust is a single substitution, a single insertion or deletion, or a transposition of adjacent characters.
+    The relation is symmetrical. Does not allocate.
+*/
+bool is_bust(const std::string_view call, const std::string_view copied) noexcept;
+
+// -----------  packed_call  ----------------
+
+/*! \class  packed_call
+    \brief  A call packed into sixteen bytes, so that calls may be compared a word at a time
+
+    Calls of up to fifteen characters are held inline, padded with zeroes, with the length in the
+    final byte. Longer calls, which are rare, hold a pointer to the characters instead; the
+    characters must outlive the packed_call.
+*/
+
+class alignas(16) packed_call
+{
+protected:
+
+  static constexpr size_t  MAX_INLINE { 15 };       ///< maximum length of a call held inline
+  static constexpr uint8_t LONG_CALL  { 0xFF };     ///< value of the final byte for a call that is not held inline
+
+  unsigned char _bytes[16] { };                     ///< characters and length; or pointer, length and LONG_CALL
+
+public:
+
+/// default constructor; the empty call
+  packed_call(void) = default;
+
+/*! \brief          Constructor
+    \param  call    call to pack, whose characters must outlive the object if the call is longer than fifteen characters
+*/
+  explicit packed_call(const std::string_view call) noexcept
+  { if (call.size() <= MAX_INLINE)
+    { if (!call.empty())
+        memcpy(_bytes, call.data(), call.size());
+
+      _bytes[15] = static_cast<uint8_t>(call.size());
+    }
+    else
+    { const char*    data   { call.data() };
+      const uint32_t length { static_cast<uint32_t>(call.size()) };
+
+      memcpy(_bytes, &data, sizeof(data));
+      memcpy(_bytes + 8, &length, sizeof(length));
+      _bytes[15] = LONG_CALL;
+    }
+  }
+
+/// is the call held inline?
+  inline bool is_inline(void) const
+    { return (_bytes[15] != LONG_CALL); }
+
+/// the length of a call held inline
+  inline size_t inline_length(void) const
+    { return _bytes[15]; }
+
+/// the call
+  inline std::string_view view(void) const
+  { if (is_inline())
+      return { reinterpret_cast<const char*>(_bytes), _bytes[15] };
+
+    const char* data;
+    uint32_t    length;
+
+    memcpy(&data, _bytes, sizeof(data));
+    memcpy(&length, _bytes + 8, sizeof(length));
+
+    return { data, length };
+  }
+
+/*! \brief      One of the two eight-byte words of the packed call
+    \param  n   which word (0 or 1)
+    \return     word number <i>n</i>
+*/
+  inline uint64_t word(const int n) const
+  { uint64_t rv;
+
+    memcpy(&rv, _bytes + 8 * n, sizeof(rv));
+    return rv;
+  }
+};
+
+/*! \brief          Is a packed copied call a bust of another packed call?
+    \param  call    target (correct) call
+    \param  copied  copied call
+    \return         whether <i>copied</i> is a plausible bust of <i>call</i>
+
+    Equivalent to is_bust(call.view(), copied.view()), but most non-busts are rejected by comparing whole words
+*/
+bool is_bust(const packed_call& call, const packed_call& copied) noexcept;
+
+/*! \brief              Test a call against many candidates
+    \param  call        target call
+    \param  candidates  contiguous candidate calls
+    \param  mask        on return, element <i>n</i> is non-zero if and only if <i>candidates[n]</i> is a bust of <i>call</i>
+
+    <i>mask</i> is supplied by the caller so that it may be reused without further allocation
+*/
+void bust_mask(const packed_call& call, std::span<const packed_call> candidates, std::vector<uint8_t>& mask) noexcept;
+
+// -----------  bust_index  ----------------
+
+/*! \class  bust_index
+    \brief  An index of calls, from which all the plausible busts of any call may be found quickly
+
+    Each indexed call is filed under a set of keys: the call itself, and the call with each
+    one of its characters deleted. Two calls that are busts of one another always share
+    at least one key, so the candidates for a call are just the calls filed under its own keys;
+    is_bust() is then applied to each candidate.
+*/
+
+class bust_index
+{
+protected:
+
+  using KEY = uint64_t;                                 ///< hash of a key
+
+  const call_table&                    _calls;          ///< table in which the calls are interned
+  std::vector<std::pair<KEY, CALL_ID>> _entries { };    ///< every key of every indexed call, sorted by key
+
+/*! \brief      Add a call to the index
+    \param  id  identifier of the call to add
+
+    The index is not usable until _finish() has been called
+*/
+  void _add(const CALL_ID id);
+
+/// sort the entries so that they may be searched
+  void _finish(void);
+
+public:
+
+/*! \brief              Constructor
+    \param  call_ids    the calls to index
+    \param  calls       table in which the calls are interned
+*/
+  template <typename C>
+    requires std::is_same_v<typename C::value_type, CALL_ID>
+  bust_index(const C& call_ids, const call_table& calls) :
+    _calls(calls)
+  { for (const CALL_ID id : call_ids)
+      _add(id);
+
+    _finish();
+  }
+
+/*! \brief          Find all the indexed calls that are busts of a call
+    \param  call    call whose busts are to be found
+    \param  rv      vector into which the busts are placed; any prior contents are removed
+
+    <i>rv</i> is supplied by the caller so that it may be reused without further allocation
+*/
+  void busts(const std::string_view call, std::vector<CALL_ID>& rv) const;
+
+/// is the index empty?
+  inline bool empty(void) const
+    { return _entries.empty(); }
+};
+
+/*! \brief              Given a container of calls, for each one return a list of possible busts from the container
+    \param  call_ids    container of calls
+    \param  calls       table in which the calls are interned
+    \param  mr          resource from which the map and the sets are allocated
+    \return             for each call in <i>call_ids</i> a set of possible busts of the call from those in <i>call_ids</i>
+    
+    If there are no possible busts for a call, no entry is placed into the map
+*/
+template <typename C>
+  requires std::is_same_v<typename C::value_type, CALL_ID>
+std::pmr::unordered_map<CALL_ID /* call */, std::pmr::unordered_set<CALL_ID> /* possible_busts */> possible_busts(const C& call_ids, const call_table& calls,
+                                                                                                             std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+{ std::pmr::unordered_map<CALL_ID, std::pmr::unordered_set<CALL_ID>> rv { mr };
+
+  const bust_index     index      { call_ids, calls };
+  std::vector<CALL_ID> busts_this_call;
+
+  for (const CALL_ID id : call_ids)
+  { index.busts(calls.call(id), busts_this_call);
+
+    if (!busts_this_call.empty())
+      rv[id].insert(busts_this_call.cbegin(), busts_this_call.cend());
+  }
+  
+  return rv;
+}
+
+#endif    // BUST_H
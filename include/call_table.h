@@ -0,0 +1,154 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   call_table.h
+
+    Classes for interning callsigns as dense integer identifiers
+*/
+
+#ifndef CALL_TABLE_H
+#define CALL_TABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using CALL_ID = uint32_t;                                               ///< dense identifier of an interned call
+
+constexpr CALL_ID NO_CALL { std::numeric_limits<CALL_ID>::max() };      ///< identifier that matches no call
+
+// -----------  call_table  ----------------
+
+/*! \class  call_table
+    \brief  Map each distinct call to a dense identifier, and back again
+
+    Identifiers are allocated sequentially from zero, in the order in which calls are first seen.
+    Not thread safe; each contest, and each log while it is parsed, has its own table.
+
+    The calls and the index are allocated from an arena owned by the table, so that interning a call is
+    usually a pointer bump, and the whole table is released at once.
+*/
+
+class call_table
+{
+protected:
+
+  std::shared_ptr<std::pmr::monotonic_buffer_resource> _arena { std::make_shared<std::pmr::monotonic_buffer_resource>() };  ///< the memory of _calls and _ids; declared first, so that it is destroyed last
+
+  std::pmr::deque<std::string>                       _calls { _arena.get() };   ///< the calls, indexed by identifier; a deque, so that views into it remain valid
+  std::pmr::unordered_map<std::string_view, CALL_ID> _ids   { _arena.get() };   ///< the identifier of each call
+
+public:
+
+/// default constructor
+  call_table(void) = default;
+
+/*! \brief          Move constructor
+    \param  ct      table to be moved
+
+    The calls move without being copied, so the views in the index remain valid. The arena is shared
+    with <i>ct</i>, whose empty containers might still hold memory from it (a moved-from deque does)
+*/
+  call_table(call_table&& ct) :
+    _arena(ct._arena),
+    _calls(std::move(ct._calls)),
+    _ids(std::move(ct._ids))
+  { }
+
+/// no copying or assignment: the index views the calls, which are allocated from the arena
+  call_table(const call_table&) = delete;
+  call_table& operator=(const call_table&) = delete;
+  call_table& operator=(call_table&&) = delete;
+
+/*! \brief          Obtain the identifier of a call, creating one if necessary
+    \param  call    call to intern
+    \return         the identifier of <i>call</i>
+*/
+  CALL_ID id(std::string_view call);
+
+/*! \brief          Obtain the identifier of a call that might not be present
+    \param  call    call to find
+    \return         the identifier of <i>call</i>, or NO_CALL if <i>call</i> has not been interned
+*/
+  CALL_ID find(std::string_view call) const;
+
+/*! \brief      Obtain the call corresponding to an identifier
+    \param  id  identifier
+    \return     the call whose identifier is <i>id</i>
+*/
+  inline const std::string& call(const CALL_ID id) const
+    { return _calls[id]; }
+
+/// the number of distinct calls
+  inline size_t size(void) const
+    { return _calls.size(); }
+};
+
+// -----------  call_id_set  ----------------
+
+/*! \class  call_id_set
+    \brief  A set of interned calls, implemented as a bitmap indexed by identifier
+
+    Iteration is over the members, in the order in which they were inserted
+*/
+
+class call_id_set
+{
+protected:
+
+  std::vector<bool>    _flags   { };    ///< whether each identifier is a member
+  std::vector<CALL_ID> _members { };    ///< the members, in insertion order
+
+public:
+
+  using value_type = CALL_ID;           ///< type of the members
+
+/*! \brief      Is an identifier a member of the set?
+    \param  id  identifier to test
+    \return     whether <i>id</i> is a member
+*/
+  inline bool contains(const CALL_ID id) const
+    { return (id < _flags.size()) and _flags[id]; }
+
+/*! \brief      Add an identifier to the set
+    \param  id  identifier to add
+
+    Does nothing if <i>id</i> is already a member
+*/
+  void operator+=(const CALL_ID id);
+
+/*! \brief      Add all the members of another set
+    \param  cis set whose members are to be added
+*/
+  void operator+=(const call_id_set& cis);
+
+/// the number of members
+  inline size_t size(void) const
+    { return _members.size(); }
+
+/// is the set empty?
+  inline bool empty(void) const
+    { return _members.empty(); }
+
+/// iterators over the members
+  inline std::vector<CALL_ID>::const_iterator begin(void) const
+    { return _members.cbegin(); }
+
+  inline std::vector<CALL_ID>::const_iterator end(void) const
+    { return _members.cend(); }
+};
+
+#endif    // CALL_TABLE_H
@@ -10,7 +10,7 @@
 
 /*! \file   count_values.h
 
-    Class for counting values.
+    Classes for counting values.
 */
 
 #ifndef COUNT_VALUES_H
@@ -18,8 +18,76 @@
 
 #include "macros.h"
 
+#include <algorithm>
+#include <concepts>
 #include <functional>
+#include <limits>
+#include <span>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------  count_buckets  ---------------------------------
+
+/*! \class  count_buckets
+    \brief  Counted values, grouped by count in order of greatest count to least
+
+    Within a bucket, the values are in ascending order
+*/
+
+template <class T, class U = int32_t>
+class count_buckets
+{
+protected:
+
+  std::vector<T>      _values { };      ///< all the values, bucket by bucket
+  std::vector<U>      _counts { };      ///< the count of each bucket
+  std::vector<size_t> _starts { 0 };    ///< index in _values of the first value of each bucket, and then of the end of _values
+
+public:
+
+/// default constructor
+  count_buckets(void) = default;
+
+/*! \brief                      Constructor
+    \param  values_and_counts   values and their counts, sorted by descending count and then by ascending value
+*/
+  explicit count_buckets(const std::vector<std::pair<T, U>>& values_and_counts)
+  { _values.reserve(values_and_counts.size());
+
+    for (const auto& [ value, n ] : values_and_counts)
+    { if (_counts.empty() or (n != _counts.back()))
+      { if (!_counts.empty())
+          _starts.push_back(_values.size());
+
+        _counts.push_back(n);
+      }
+
+      _values.push_back(value);
+    }
+
+    if (!_counts.empty())
+      _starts.push_back(_values.size());
+  }
+
+/// number of buckets
+  inline size_t size(void) const
+    { return _counts.size(); }
+
+/*! \brief      Obtain the count of a bucket
+    \param  n   number of the bucket, counting from zero
+    \return     the count shared by all the values in bucket number <i>n</i>
+*/
+  inline U count(const size_t n) const
+    { return _counts[n]; }
+
+/*! \brief      Obtain the values in a bucket
+    \param  n   number of the bucket, counting from zero
+    \return     the values in bucket number <i>n</i>, in ascending order
+*/
+  inline std::span<const T> values(const size_t n) const
+    { return std::span<const T> { _values }.subspan(_starts[n], _starts[n + 1] - _starts[n]); }
+};
 
 // -----------------------------------------------------  count_values  ---------------------------------
 
@@ -31,80 +99,109 @@ template <class T, class U = int32_t>
 class count_values : public std::unordered_map<T, U>
 {
 protected:
-  
+
 public:
 
 /// return the number of distinguishable values
   inline size_t n_values(void) const
-    { return std::unordered_map<T, U>(*this).size(); }
+    { return this->size(); }
 
 /// return the sum total of counts
   U total_count(void) const
   { U rv { };
- 
-    for (const auto& [ value, n ] : std::unordered_map<T, U>(*this))
+
+    for (const auto& [ value, n ] : *this)
       rv += n;
-     
+
      return rv;
   }
 
 /// add one to a count (and create it if it is not extant)
   void operator+=(const T& v)
   { std::unordered_map<T, U>* p { this };
-   
+
     (*p)[v]++;
   }
 
-/// get the value and corresponding count for the largest count 
+/// get the value and corresponding count for the largest count
   std::pair<T, U> maximum(void) const
   { std::pair<T, U> rv;
- 
+
     U max_value { std::numeric_limits<U>::min() };
- 
-    for (const auto& [ value, n ] : std::unordered_map<T, U>(*this))
+
+    for (const auto& [ value, n ] : *this)
     { if (n > max_value)
-        rv = { value, n };
+      { rv = { value, n };
+        max_value = n;
+      }
     }
-   
+
     return rv;
   }
 
 /// get the value and corresponding count for the least count
   std::pair<T, U> minimum(void) const
   { std::pair<T, U> rv;
- 
+
     U min_value { std::numeric_limits<U>::max() };
- 
-    for (const auto& [ value, n ] : std::unordered_map<T, U>(*this))
+
+    for (const auto& [ value, n ] : *this)
     { if (n < min_value)
-        rv = { value, n };
+      { rv = { value, n };
+        min_value = n;
+      }
     }
-   
+
     return rv;
   }
 
-/// invert, so that the count is the key into a container of values 
+/// invert, so that the count is the key into a container of values
   template <typename OUTVALUES, typename OUTSORT = std::less<U>>
   auto sorted_invert(void) const -> std::map<U, OUTVALUES, OUTSORT>
   { std::map<U, OUTVALUES, OUTSORT> rv { };
- 
-    for (const auto& [ value, n ] : std::unordered_map<T, U>(*this))
-      rv[n] += value; 
+
+    for (const auto& [ value, n ] : *this)
+      rv[n] += value;
 
     return rv;
   }
 
-/// add one (or create an entry if necessary) for each of a vector of values 
+/// the values grouped by count, in order of greatest count to least
+  count_buckets<T, U> by_count_descending(void) const
+  { std::vector<std::pair<T, U>> values_and_counts { this->begin(), this->end() };
+
+    SORT(values_and_counts, [] (const std::pair<T, U>& a, const std::pair<T, U>& b) { return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first); });
+
+    return count_buckets<T, U> { values_and_counts };
+  }
+
+/*! \brief      Obtain the values with the largest counts
+    \param  k   maximum number of values to return
+    \return     at most <i>k</i> values and their counts, in order of greatest count to least; ties are in ascending order of value
+*/
+  std::vector<std::pair<T, U>> top_k(const size_t k) const
+  { std::vector<std::pair<T, U>> rv { this->begin(), this->end() };
+
+    const auto greater_count { [] (const std::pair<T, U>& a, const std::pair<T, U>& b) { return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first); } };
+    const size_t n { std::min(k, rv.size()) };
+
+    std::partial_sort(rv.begin(), rv.begin() + n, rv.end(), greater_count);
+    rv.resize(n);
+
+    return rv;
+  }
+
+/// add one (or create an entry if necessary) for each of a vector of values
   inline void operator+=(const std::vector<T>& tvec)
     { FOR_ALL(tvec, [this] (const T& v) { (*this) += v; }); }
 
 #if 0
-  template <class UnaryPredicate>   
+  template <class UnaryPredicate>
   std::unordered_set<T> filter(UnaryPredicate pred)
   { std::unordered_set<T> rv;
-  
+
     APPEND_IF(std::unordered_map<T, U>(*this), rv, pred);
- 
+
     return rv;
   }
 #endif
@@ -114,5 +211,117 @@ public:
 template<class T, class U>
 constexpr bool is_specialization<count_values<T, U>, std::unordered_map> = true;
 
-#endif              // COUNT_VALUES_H
+// -----------------------------------------------------  dense_count_values  ---------------------------------
 
+/*! \class  dense_count_values
+    \brief  Count values that are small unsigned integers, such as interned identifiers
+
+    The counts are held in a vector indexed by value, so no hashing is needed.
+    Iteration is over the values that have been counted, in the order in which they were first counted.
+*/
+
+template <std::unsigned_integral T, class U = int32_t>
+class dense_count_values
+{
+protected:
+
+  std::vector<U> _counts { };   ///< the count of each value; zero if the value has not been counted
+  std::vector<T> _values { };   ///< the values that have been counted, in the order in which they were first counted
+
+public:
+
+/// add one to a count
+  void operator+=(const T v)
+  { if (v >= _counts.size())
+      _counts.resize(v + 1, 0);
+
+    if (_counts[v]++ == 0)
+      _values.push_back(v);
+  }
+
+/// add one for each of a vector of values
+  inline void operator+=(const std::vector<T>& tvec)
+    { FOR_ALL(tvec, [this] (const T v) { (*this) += v; }); }
+
+/// the count of a value; zero if the value has not been counted
+  inline U operator[](const T v) const
+    { return ( (v < _counts.size()) ? _counts[v] : 0 ); }
+
+/// return the number of distinguishable values
+  inline size_t n_values(void) const
+    { return _values.size(); }
+
+/// return the sum total of counts
+  U total_count(void) const
+  { U rv { };
+
+    for (const T v : _values)
+      rv += _counts[v];
+
+    return rv;
+  }
+
+/// remove all the counts, retaining the storage
+  void clear(void)
+  { for (const T v : _values)
+      _counts[v] = 0;
+
+    _values.clear();
+  }
+
+/// the values grouped by count, in order of greatest count to least; linear in the number and range of the values
+  count_buckets<T, U> by_count_descending(void) const
+  { U max_count { 0 };
+
+    for (const T v : _values)
+      max_count = std::max(max_count, _counts[v]);
+
+// counting sort on the count; visiting the values in ascending order keeps each bucket in ascending order
+    std::vector<size_t> posn(static_cast<size_t>(max_count) + 2, 0);       // index of the next slot for each count, in descending order of count
+
+    for (const T v : _values)
+      posn[max_count - _counts[v] + 1]++;
+
+    for (size_t n { 1 }; n < posn.size(); ++n)
+      posn[n] += posn[n - 1];
+
+    std::vector<std::pair<T, U>> values_and_counts(_values.size());
+
+    for (size_t v { 0 }; v < _counts.size(); ++v)
+      if (const U n { _counts[v] }; n != 0)
+        values_and_counts[posn[max_count - n]++] = { static_cast<T>(v), n };
+
+    return count_buckets<T, U> { values_and_counts };
+  }
+
+/*! \brief      Obtain the values with the largest counts
+    \param  k   maximum number of values to return
+    \return     at most <i>k</i> values and their counts, in order of greatest count to least; ties are in ascending order of value
+*/
+  std::vector<std::pair<T, U>> top_k(const size_t k) const
+  { std::vector<std::pair<T, U>> rv;
+
+    rv.reserve(_values.size());
+
+    for (const T v : _values)
+      rv.emplace_back(v, _counts[v]);
+
+    const auto greater_count { [] (const std::pair<T, U>& a, const std::pair<T, U>& b) { return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first); } };
+    const size_t n { std::min(k, rv.size()) };
+
+    std::partial_sort(rv.begin(), rv.begin() + n, rv.end(), greater_count);
+    rv.resize(n);
+
+    return rv;
+  }
+
+/// the first of the values that have been counted
+  inline typename std::vector<T>::const_iterator begin(void) const
+    { return _values.begin(); }
+
+/// one past the last of the values that have been counted
+  inline typename std::vector<T>::const_iterator end(void) const
+    { return _values.end(); }
+};
+
+#endif              // COUNT_VALUES_H
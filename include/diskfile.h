@@ -19,6 +19,8 @@
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -50,6 +52,47 @@ public:
     { return _what.c_str(); }
 };
 
+// -----------  memory_mapped_file  ----------------
+
+/*! \class  memory_mapped_file
+    \brief  The contents of a file, mapped privately into memory
+
+    The mapping is copy-on-write: the contents may be modified in place, but
+    the modifications are never written back to the file.
+*/
+
+class memory_mapped_file
+{
+protected:
+
+  char*  _data { nullptr };     ///< start of the mapping; nullptr if the file is empty
+  size_t _size { 0 };           ///< length of the file, in bytes
+
+public:
+
+/*! \brief              Constructor
+    \param  filename    name of file to map
+
+    Throws diskfile_exception if the file cannot be opened, is not a regular file, or cannot be mapped
+*/
+  explicit memory_mapped_file(const std::string& filename);
+
+/// no copying: the object owns the mapping
+  memory_mapped_file(const memory_mapped_file&) = delete;
+  memory_mapped_file& operator=(const memory_mapped_file&) = delete;
+
+/// destructor; unmaps the file
+  ~memory_mapped_file(void);
+
+/// the contents of the file, which may be modified
+  inline std::span<char> contents(void)
+    { return { _data, _size }; }
+
+/// the length of the file, in bytes
+  inline size_t size(void) const
+    { return _size; }
+};
+
 /*! \brief              Append a string to a file
     \param  filename    name of file
     \param  str         string to be appended
@@ -16,8 +16,14 @@
 #ifndef DRSCP_H
 #define DRSCP_H
 
+#include "bust.h"
+#include "call_table.h"
 #include "string_functions.h"
 
+#include <array>
+#include <numeric>
+#include <span>
+
 extern bool DISPLAY_BAD_QSOS;
 
 enum class HF_BAND { B160 = 0,
@@ -31,62 +37,348 @@ enum class HF_BAND { B160 = 0,
 
 static const std::vector<std::string> HF_BAND_STR { "160"s, "80"s, "40"s, "20"s, "15"s, "10"s, "BAD"s };
 
+class band_log;
+class collated_calls;
+class contest_logs;
 class small_qso;
+class stage_timer;
 class contest_parameters;
+class thread_pool;
 
-using CALL_MAP = std::map<std::string, int, decltype(&compare_calls)>;      // accumulator in callsign order
 using CALL_SET = std::set<std::string, decltype(&compare_calls)>;           // set in callsign order
 
 // forward declarations
-HF_BAND                band_from_qrg(const int qrg);
-auto                   build_minilog(const std::unordered_map<std::string /* tcall */, std::vector<small_qso>>& qsos_per_call) -> std::unordered_map<HF_BAND, base_type<decltype(qsos_per_call)>>;
-std::vector<small_qso> build_vec(const std::unordered_map<std::string /* tcall */, std::vector<small_qso>>& qsos_per_call);
-
-std::unordered_set<std::string> calls_with_unreliable_freq(const std::unordered_map<std::string /* tcall */, std::vector<small_qso>>& all_qsos, const std::unordered_set<std::string>& calls_with_no_freq_info);
-
-std::pair<std::vector<small_qso>::const_iterator, std::vector<small_qso>::const_iterator> get_bounds(const int target_minutes, const int minimum_minutes, const int maximum_minutes,
-                                                                                                     const int ALLOWED_SKEW, const std::vector<small_qso>& vec);
+HF_BAND                band_from_qrg(const int qrg) noexcept;
+auto                   build_minilog(const std::unordered_map<CALL_ID /* tcall */, std::vector<small_qso>>& qsos_per_call, const int max_rel_mins, const call_table& calls,
+                                     const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info) -> std::unordered_map<HF_BAND, band_log>;
+std::string            call_parameters(void);
+std::vector<small_qso> build_vec(const std::unordered_map<CALL_ID /* tcall */, std::vector<small_qso>>& qsos_per_call);
+uint64_t               estimated_footprint(const contest_parameters& cp);
+std::pair<uint64_t /* bytes */, size_t /* logs */> log_sizes(const contest_parameters& cp);
+bool                   has_pruned_qsos(const band_log& bl, const call_id_set& known_calls);
+
+call_id_set calls_with_unreliable_freq(const std::unordered_map<CALL_ID /* tcall */, std::vector<small_qso>>& all_qsos, const call_id_set& calls_with_no_freq_info,
+                                       const size_t n_calls, thread_pool& pool, stage_timer& timer);
+
+std::pair<std::span<const uint32_t>::iterator, std::span<const uint32_t>::iterator> get_bounds(const int target_minutes, const int minimum_minutes, const int maximum_minutes,
+                                                                                               const int ALLOWED_SKEW, std::span<const uint32_t> rows, const band_log& bl);
                                                                                                      
-bool    is_bust(const std::string& call, const std::string& copied) noexcept;
-bool    is_stn_running(const std::string& call, const int rel_mins, const int qrg, const std::unordered_set<std::string>& tcalls, const std::unordered_set<std::string>& calls_with_no_freq_info,
-                       const std::unordered_set<std::string>& calls_with_poor_freq_info, const std::unordered_map<std::string /* tcall */, std::vector<small_qso>>& all_qsos_this_band,
-                       const std::vector<small_qso>& all_vec,
-                       const std::vector<std::vector<small_qso>::const_iterator>& all_time_map, const int minimum_minutes, const int maximum_minutes,
-                       const std::string& ignore_call);
+int     leading_int(const std::string_view sv) noexcept;
+std::string output_filename(const std::string& filename, const std::vector<int>& pcs, const size_t n);
                       
-std::unordered_set<std::string> process_band(const std::unordered_map<std::string /* tcall */, std::vector<small_qso>>& pruned_qsos_this_band,
-                                             const std::unordered_map<std::string /* tcall */, std::vector<small_qso>>& all_qsos_this_band,
-                                             const std::unordered_set<std::string>& calls_with_no_freq_info,
-                                             const std::unordered_set<std::string>& calls_with_poor_freq_info,
-                                             const int max_rel_mins);
-CALL_MAP process_directory(const contest_parameters& cp);
+call_id_set process_band(const band_log& all_qsos_this_band,
+                         const call_id_set& known_calls,
+                         const call_id_set& calls_with_no_freq_info,
+                         const call_id_set& calls_with_poor_freq_info,
+                         const int max_rel_mins,
+                         const call_table& calls,
+                         const std::string& dirname,
+                         thread_pool& pool);
+std::vector<call_id_set> process_bands_from_spill(std::unordered_map<CALL_ID /* tcall */, std::vector<small_qso>>& all_qsos, const call_id_set& known_calls,
+                                                  const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info,
+                                                  const int max_rel_mins, const call_table& calls, const std::string& dirname, stage_timer& timer,
+                                                  thread_pool& pool);
+collated_calls process_directory(const contest_parameters& cp, thread_pool& pool);
+contest_logs read_logs(const contest_parameters& cp, const std::vector<std::string>& filenames, const std::string& key, thread_pool& pool, stage_timer& timer);
+
+int remove_qsos_outside_contest_period(std::unordered_map<CALL_ID /* tcall */, std::vector<small_qso>>& all_qsos);
+
+// -----------  collated_calls  ----------------
+
+/*! \class  collated_calls
+    \brief  Calls and their counts, held as a flat vector in callsign sort order
+
+    Each call is held as its collation key, so that calls are ordered and merged by ordinary string comparison
+*/
+
+class collated_calls
+{
+protected:
+
+  std::vector<std::pair<std::string /* collation key */, int /* count */>> _entries { };      ///< the calls, in ascending order of collation key
+
+public:
+
+/// default constructor
+  collated_calls(void) = default;
+
+/*! \brief                      Constructor
+    \param  calls_and_counts    distinct calls and their counts, in any order
+*/
+  explicit collated_calls(const std::vector<std::pair<std::string, int>>& calls_and_counts);
+
+/*! \brief          Constructor from the merger of several sets of calls
+    \param  ccs     the sets to be merged
+
+    The count of a call that appears in more than one set is the sum of its counts
+*/
+  explicit collated_calls(std::span<const collated_calls> ccs);
+
+  READ(entries);                            ///< the calls, as collation keys, in ascending order of collation key
+
+/// the number of calls
+  inline size_t size(void) const
+    { return _entries.size(); }
+
+/*! \brief      Apply a function to each call, in callsign sort order
+    \param  f   function that takes a call and its count
+*/
+  template <typename F>
+  void for_each_call(F&& f) const
+  { for (const auto& [ key, count ] : _entries)
+      f(call_from_collation_key(key), count);
+  }
+};
+
+// -----------  for_all_qso_lines  ----------------
+
+/*! \brief                  Split the QSO lines in the contents of a Cabrillo file into fields, in place
+    \param  content         contents of the file, which are modified
+    \param  fields          buffer to hold the fields of each line
+    \param  process_fields  function to be called with the fields of each QSO line
+
+    Each line that begins with "QSO:" (in any case) is converted to upper case in <i>content</i>,
+    and split into fields, separated by runs of spaces and tabs. The result is the same as replacing
+    tabs with spaces, squashing spaces, converting to upper case and then splitting into lines and
+    fields; but it is performed in a single pass, without copying. <i>fields</i> is reused for every line.
+*/
+template <typename F>
+void for_all_qso_lines(std::span<char> content, std::vector<std::string_view>& fields, F&& process_fields)
+{ auto upper = [] (const char c) { return ( ((c >= 'a') and (c <= 'z')) ? static_cast<char>(c - 'a' + 'A') : c ); };
+
+  char*       posn { content.data() };
+  char* const end  { posn + content.size() };
+
+  while (posn != end)
+  { char* const eol { std::find(posn, end, '\n') };
+
+    if ( ((eol - posn) >= 4) and (upper(posn[0]) == 'Q') and (upper(posn[1]) == 'S') and (upper(posn[2]) == 'O') and (posn[3] == ':') )
+    { char* field_start { nullptr };           // nullptr when not in a field
+
+      fields.clear();
+
+      for (char* cp { posn }; cp != eol; ++cp)
+      { if ( (*cp == ' ') or (*cp == '\t') )
+        { if (field_start)
+          { fields += std::string_view { field_start, cp };
+            field_start = nullptr;
+          }
+        }
+        else
+        { *cp = upper(*cp);
 
-int remove_qsos_outside_contest_period(std::unordered_map<std::string /* tcall */, std::vector<small_qso>>& all_qsos);
+          if (!field_start)
+            field_start = cp;
+        }
+      }
 
-// operators to append to CALL_MAP
-void operator+=(CALL_MAP& cm, const std::unordered_set<std::string>& us)
-  { std::for_each( us.cbegin(), us.cend(), [&cm] (auto& element) { (cm[element])++; } ); }
+      if (field_start)
+        fields += std::string_view { field_start, eol };
 
-void operator+=(CALL_MAP& cm, const CALL_MAP& us)
-  { std::for_each( us.cbegin(), us.cend(), [&cm] (auto& pr) { cm[pr.first] += pr.second; } ); }
+      process_fields(fields);
+    }
 
-void operator+=(CALL_MAP& cm, const std::string& call)
-  { (cm[call])++; }
+    posn = ( (eol == end) ? end : eol + 1 );
+  }
+}
   
+// -----------  qso_decoder  ----------------
+
+/// reasons for rejecting a QSO line
+enum class QSO_REJECT { SHORT_LINE = 0,
+                        TCALL_NO_LETTER,
+                        TCALL_NO_DIGIT,
+                        RCALL_NO_LETTER,
+                        RCALL_NO_DIGIT,
+                        BAD_FREQUENCY,
+                        OUTSIDE_CONTEST,
+                        ILLEGAL_CALL,
+                        N_REASONS           // must be last
+                      };
+
+static const std::vector<std::string> QSO_REJECT_STR { "short line"s, "tcall without letter"s, "tcall without digit"s, "rcall without letter"s, "rcall without digit"s,
+                                                       "frequency not in a contest band"s, "outside contest period"s, "illegal call"s
+                                                     };
+
+/*! \class  qso_decoder
+    \brief  State shared by all the QSOs read from a single log
+
+    Holds the call table, caches the day number of each distinct date, numbers the QSO lines,
+    counts the rejected lines and holds any messages about them.
+    Not thread safe; each log has its own decoder.
+*/
+
+class qso_decoder
+{
+protected:
+
+  static constexpr size_t MAX_CACHED_DATES { 8 };                  ///< contests span only a few dates; logs with more distinct dates than this are mostly garbage
+
+  call_table& _calls;                                               ///< table in which to intern the calls
+
+  time_t _t_start;                                                  ///< time of the start of the contest
+  time_t _t_end;                                                    ///< one second past the end of the contest
+
+  std::vector<std::pair<std::string, int64_t>> _date_cache { };     ///< days since the epoch, for each date field already seen
+
+  int _n_qso_lines { 0 };                                            ///< number of QSO lines decoded
+
+  std::array<int, static_cast<size_t>(QSO_REJECT::N_REASONS)> _rejects { };     ///< number of lines rejected, for each reason
+
+  std::ostringstream _bad_qsos { };                                 ///< messages about rejected lines, to be displayed on cerr
+
+public:
+
+/*! \brief              Constructor
+    \param  calls       table in which to intern the calls
+    \param  t_start     time of the start of the contest
+    \param  t_end       one second past the end of the contest
+*/
+  qso_decoder(call_table& calls, const time_t t_start, const time_t t_end) :
+    _calls(calls),
+    _t_start(t_start),
+    _t_end(t_end)
+  { }
+
+  READ(t_start);                    ///< time of the start of the contest
+  READ(n_qso_lines);                ///< number of QSO lines decoded
+
+/// table in which to intern the calls
+  inline call_table& calls(void)
+    { return _calls; }
+
+/*! \brief      Is a particular time within the contest period?
+    \param  t   time to test
+    \return     whether <i>t</i> is within the contest
+*/
+  inline bool in_contest_period(const time_t t) const
+    { return (t >= _t_start) and (t < _t_end); }
+
+/*! \brief          Convert the date and time fields of a QSO line to a time
+    \param  dat     date field, YYYY-MM-DD
+    \param  utc     time field, HHMM
+    \return         the time represented by <i>dat</i> and <i>utc</i>
+
+    Out-of-range values are normalised in the same way as by timegm()
+*/
+  time_t time(const std::string_view dat, const std::string_view utc);
+
+/// obtain the identifier of the next QSO line, relative to the start of the log
+  inline int next_qso_line(void)
+    { return _n_qso_lines++; }
+
+/// stream for messages about rejected lines
+  inline std::ostringstream& bad_qsos(void)
+    { return _bad_qsos; }
+
+/*! \brief          Record the rejection of a line
+    \param  reason  reason for the rejection
+*/
+  inline void reject(const QSO_REJECT reason)
+    { _rejects[static_cast<size_t>(reason)]++; }
+
+/*! \brief          The number of lines rejected for a particular reason
+    \param  reason  reason for the rejection
+    \return         the number of lines rejected because of <i>reason</i>
+*/
+  inline int rejects(const QSO_REJECT reason) const
+    { return _rejects[static_cast<size_t>(reason)]; }
+
+/// the total number of rejected lines
+  inline int total_rejects(void) const
+    { return std::accumulate(_rejects.cbegin(), _rejects.cend(), 0); }
+};
+
+// -----------  call_properties  ----------------
+
+constexpr uint8_t CALL_CHAR_LETTER   { 1 };     ///< class bit of a letter, of either case
+constexpr uint8_t CALL_CHAR_DIGIT    { 2 };     ///< class bit of a digit
+constexpr uint8_t CALL_CHAR_CALLSIGN { 4 };     ///< class bit of a character in CALLSIGN_CHARS
+
+/// the class bits of each character
+constexpr std::array<uint8_t, 256> CALL_CHAR_CLASS { [] (void)
+  { std::array<uint8_t, 256> rv { };
+
+    for (unsigned int c { 0 }; c < 256; ++c)
+    { const bool upper { (c >= 'A') and (c <= 'Z') };
+      const bool digit { (c >= '0') and (c <= '9') };
+
+      if (upper or ( (c >= 'a') and (c <= 'z') ))
+        rv[c] |= CALL_CHAR_LETTER;
+
+      if (digit)
+        rv[c] |= CALL_CHAR_DIGIT;
+
+      if (upper or digit or (c == '/'))
+        rv[c] |= CALL_CHAR_CALLSIGN;
+    }
+
+    return rv;
+  } () };
+
+/*! \class  call_properties
+    \brief  The properties of a logged call that decide whether a QSO is accepted, found in a single pass over the call
+
+    Replaces separate searches for a letter, for a digit and for a character that is not in CALLSIGN_CHARS
+*/
+
+class call_properties
+{
+protected:
+
+  std::string_view _normalised;         ///< the call, without any /QRP or /QRPP suffix
+
+  bool _has_letter { false };           ///< whether the call contains a letter, of either case
+  bool _has_digit  { false };           ///< whether the call contains a digit
+  bool _legal      { false };           ///< whether every character of the call is in CALLSIGN_CHARS
+
+public:
+
+/*! \brief          Constructor
+    \param  call    call to classify, which must outlive the object
+*/
+  explicit call_properties(const std::string_view call) :
+    _normalised(call)
+  { uint8_t any_bits { 0 };                       // the bits of at least one character
+    uint8_t all_bits { CALL_CHAR_CALLSIGN };      // the bits of every character
+
+    for (const char c : call)
+    { const uint8_t bits { CALL_CHAR_CLASS[static_cast<unsigned char>(c)] };
+
+      any_bits |= bits;
+      all_bits &= bits;
+    }
+
+    _has_letter = (any_bits & CALL_CHAR_LETTER);
+    _has_digit = (any_bits & CALL_CHAR_DIGIT);
+    _legal = (all_bits & CALL_CHAR_CALLSIGN);
+
+// yup... some people do this
+    if (_normalised.ends_with("/QRP"sv))
+      _normalised.remove_suffix(4);
+
+    if (_normalised.ends_with("/QRPP"sv))
+      _normalised.remove_suffix(5);
+  }
+
+  READ(normalised);             ///< the call, without any /QRP or /QRPP suffix
+  READ(has_letter);             ///< whether the call contains a letter, of either case
+  READ(has_digit);              ///< whether the call contains a digit
+  READ(legal);                  ///< whether every character of the call is in CALLSIGN_CHARS
+};
+
 // -----------  small_qso  ----------------
 
 /*! \class  small_qso
     \brief  Minimal data about a logged QSO
 */
 
-static constinit int qso_id { 0 };      ///< global QSO counter
-
 class small_qso         // small QSO
 {
 protected:
   
-  std::string _tcall { };           ///< transmitted call
-  std::string _rcall { };           ///< received call
+  CALL_ID _tcall { NO_CALL };       ///< transmitted call
+  CALL_ID _rcall { NO_CALL };       ///< received call
   
   HF_BAND _band { HF_BAND::BAD };   ///< band
   
@@ -95,7 +387,7 @@ protected:
   time_t _time     { };             ///< UTC time
   int    _rel_mins { };             ///< relative minutes from the start of the contest
   
-  int _id;                          ///< unique QSO identifier
+  int _id;                          ///< unique QSO identifier; relative to the start of the log until rebase() is called
   
 public:
 
@@ -103,104 +395,411 @@ public:
 
 /*! \brief              Constructor
     \param  qso_fields  fields taken from a line in a Cabrillo file
+    \param  decoder     decoder for the contest, which holds the table in which to intern the calls
+
+    If the QSO is unusable, the constructed object is not valid(), and the reason is recorded in <i>decoder</i>
 */
-small_qso(const std::vector<std::string_view>& qso_fields) :
-    _id(qso_id++)
-  { auto process_error = [qso_fields, this] (const std::string& msg)
-      { if (DISPLAY_BAD_QSOS)
-        { std::cerr << msg << ": ";
+small_qso(const std::vector<std::string_view>& qso_fields, qso_decoder& decoder) :
+    _id(decoder.next_qso_line())
+  { auto process_error = [&decoder, &qso_fields, this] (const QSO_REJECT reason, const std::string& msg = std::string())
+      { if (DISPLAY_BAD_QSOS and !msg.empty())        // some reasons are silent
+        { std::ostringstream& ost { decoder.bad_qsos() };
+
+          ost << msg << ": ";
       
           for (const auto& field : qso_fields)
-            std::cerr << field << " ";
-          std::cerr << std::endl;
+            ost << field << " ";
+          ost << std::endl;
         }
       
+        decoder.reject(reason);
         *this = small_qso { };
       };
     
     if (qso_fields.size() < 9)
-    { process_error("ERROR constructing small_qso from short vector");
+    { process_error(QSO_REJECT::SHORT_LINE, "ERROR constructing small_qso from short vector");
       return;
     }
     
-    _qrg = from_string<int>(std::string { qso_fields[1] });
-    _tcall = qso_fields[5];
-    _rcall = qso_fields[8];
+    _qrg = leading_int(qso_fields[1]);
+
+    const std::string_view tcall { qso_fields[5] };
+    const std::string_view rcall { qso_fields[8] };
+
+    const call_properties tcall_properties { tcall };
+    const call_properties rcall_properties { rcall };
     
-    if (!contains_letter(_tcall))
-    { process_error("tcall does not contain letter");
+    if (!tcall_properties.has_letter())
+    { process_error(QSO_REJECT::TCALL_NO_LETTER, "tcall does not contain letter");
       return;
     }
 
-    if (!contains_digit(_tcall))
-    { process_error("tcall does not contain digit");
+    if (!tcall_properties.has_digit())
+    { process_error(QSO_REJECT::TCALL_NO_DIGIT, "tcall does not contain digit");
       return;
     }
 
-    if (!contains_letter(_rcall))
-    { process_error("rcall does not contain letter");
+    if (!rcall_properties.has_letter())
+    { process_error(QSO_REJECT::RCALL_NO_LETTER, "rcall does not contain letter");
       return;
     }
 
-    if (!contains_digit(_rcall))
-    { process_error("rcall does not contain digit");
+    if (!rcall_properties.has_digit())
+    { process_error(QSO_REJECT::RCALL_NO_DIGIT, "rcall does not contain digit");
       return;
     }
     
-    try
-    { _band = band_from_qrg(_qrg);
-    }
-    
-    catch (...)
-    { process_error("error in frequency");
+    if (_band = band_from_qrg(_qrg); _band == HF_BAND::BAD)
+    { process_error(QSO_REJECT::BAD_FREQUENCY, "error in frequency");
       return;
     }
       
-// we don't yet have proper support for date/time in g++
-    struct tm t { };
-    
-    const std::string dat { qso_fields[3] };
-    const std::string utc { qso_fields[4] };
-
-// see: https://www.epochconverter.com/programming/c
-    t.tm_year = from_string<int>(substring(dat, 0, 4)) - 1900;
-    t.tm_mon  = from_string<int>(substring(dat, 5, 2)) - 1;
-    t.tm_mday = from_string<int>(substring(dat, 8, 2));
-    t.tm_hour = from_string<int>(substring(utc, 0, 2));
-    t.tm_min  = from_string<int>(substring(utc, 2, 2));
-    
-    _time = timegm(&t);
+    _time = decoder.time(qso_fields[3], qso_fields[4]);
+
+    if (!decoder.in_contest_period(_time))
+    { process_error(QSO_REJECT::OUTSIDE_CONTEST);
+      return;
+    }
+
+    _rel_mins = (_time - decoder.t_start()) / 60;         // minutes since the start of the contest
+
+// silently reject calls that cannot be legal
+    const char tfirst { tcall[0] };
+    const char rfirst { rcall[0] };
+          
+    if ( (tfirst == '/') or (rfirst == '/') or
+         (tfirst == 'Q') or (rfirst == 'Q') or
+         (tfirst == '0') or (rfirst == '0') )
+    { process_error(QSO_REJECT::ILLEGAL_CALL);
+      return;
+    }
+
+    const char tlast { tcall[tcall.size() - 1] };
+    const char rlast { rcall[rcall.size() - 1] };
+          
+    if ( (tlast == '/') or (rlast == '/') or
+         (tcall.size() < 3) or (rcall.size() < 3) or
+         !tcall_properties.legal() or !rcall_properties.legal() or
+         (tcall == rcall) )                 // some people "work themselves" to mark bad QSOs but to keep serial numbers intact
+    { process_error(QSO_REJECT::ILLEGAL_CALL);
+      return;
+    }
+
+    _tcall = decoder.calls().id(tcall_properties.normalised());
+    _rcall = decoder.calls().id(rcall_properties.normalised());
   }
 
+/*! \brief              Constructor from the values of a QSO that has already been validated
+    \param  tcall       transmitted call
+    \param  rcall       received call
+    \param  qrg         frequency, in kHz
+    \param  time        UTC time
+    \param  rel_mins    relative minutes from the start of the contest
+    \param  id          unique QSO identifier
+*/
+  small_qso(const CALL_ID tcall, const CALL_ID rcall, const int qrg, const time_t time, const int rel_mins, const int id) :
+    _tcall(tcall),
+    _rcall(rcall),
+    _band(band_from_qrg(qrg)),
+    _qrg(qrg),
+    _time(time),
+    _rel_mins(rel_mins),
+    _id(id)
+  { }
+
 /*! \brief              Constructor
     \param  qso_line    line from a Cabrillo file
+    \param  decoder     decoder for the contest, which holds the table in which to intern the calls
 */
-  small_qso(std::string_view qso_line)
+  small_qso(std::string_view qso_line, qso_decoder& decoder)
   { const std::vector<std::string_view> qso_fields { split_string_sv(qso_line, ' ') };  // assumes has already been squashed
   
-    *this = small_qso(qso_fields);
+    *this = small_qso(qso_fields, decoder);
   }
 
-  READ_AND_WRITE(tcall);
-  READ_AND_WRITE(rcall);
+  READ(tcall);
+  READ(rcall);
   READ(band);
   READ(qrg);
   READ_AND_WRITE(time);
-  READ(id);
+  READ_AND_WRITE(id);
   READ_AND_WRITE(rel_mins);
 
+/*! \brief              Move the QSO from the call table and numbering of its log to those of the contest
+    \param  call_ids    identifier in the contest's table of each call in the log's table
+    \param  id_base     identifier of the log's first QSO line
+*/
+  inline void rebase(const std::vector<CALL_ID>& call_ids, const int id_base)
+  { _tcall = call_ids[_tcall];
+    _rcall = call_ids[_rcall];
+    _id += id_base;
+  }
+
+/// was the QSO constructed successfully?
+  inline bool valid(void) const
+    { return (_tcall != NO_CALL); }
+
 /// small_qso < small_qso
   inline bool operator<(const small_qso& sq) const
     { return (_time < sq._time); }
+
+/*! \brief          Convert to a printable string
+    \param  calls   table in which the calls are interned
+    \return         human-readable description of the QSO
+*/
+  std::string to_string(const call_table& calls) const
+  { std::ostringstream ost;
+
+    ost << "Id: " << _id << ", time = " << _time << ", band = " << HF_BAND_STR.at(static_cast<int>(_band)) << "m"
+        << ", qrg = " << _qrg << ", tcall = " << calls.call(_tcall) << ", rcall = " << calls.call(_rcall);
+
+    return ost.str();
+  }
 };
 
-/// ostream << small_qso
-std::ostream& operator<<(std::ostream& ost, const small_qso& sq)
-{ ost << "Id: " << sq.id() << ", time = " << sq.time() << ", band = " << HF_BAND_STR.at(static_cast<int>(sq.band())) << "m"
-      << ", qrg = " << sq.qrg() << ", tcall = " << sq.tcall() << ", rcall = " << sq.rcall();
-  
-  return ost;
-}
+// -----------  parsed_log  ----------------
+
+/*! \class  parsed_log
+    \brief  The valid QSOs read from a single log, with their own call table
+
+    Logs are parsed independently of one another, and then merged into the contest in the order of
+    their files; so the calls are interned, and the QSO lines numbered, relative to the log.
+*/
+
+class parsed_log
+{
+protected:
+
+  call_table             _calls       { };          ///< the calls in the log
+  std::vector<small_qso> _qsos        { };          ///< the valid QSOs, in the order in which they appear in the log
+  int                    _n_qso_lines { 0 };        ///< number of QSO lines, valid or not
+
+  std::array<int, static_cast<size_t>(QSO_REJECT::N_REASONS)> _rejects { };     ///< number of lines rejected, for each reason
+
+  std::string _bad_qsos { };                        ///< messages about rejected lines, to be displayed on cerr
+
+public:
+
+/*! \brief              Constructor
+    \param  filename    name of the file that contains the log
+    \param  t_start     time of the start of the contest
+    \param  t_end       one second past the end of the contest
+*/
+  parsed_log(const std::string& filename, const time_t t_start, const time_t t_end);
+
+  READ(calls);                  ///< the calls in the log
+  READ(qsos);                   ///< the valid QSOs, in the order in which they appear in the log
+  READ(n_qso_lines);            ///< number of QSO lines, valid or not
+  READ(rejects);                ///< number of lines rejected, for each reason
+  READ(bad_qsos);               ///< messages about rejected lines
+};
+
+// -----------  contest_logs  ----------------
+
+/*! \class  contest_logs
+    \brief  The valid QSOs read from all the logs in a contest directory
+
+    The QSOs of each log are divided into groups by tcall. The groups are held in the order in which a serial
+    reading of the logs would encounter them: log by log, in the order of the files. Nothing here depends on
+    any parameter other than the contest period, so a contest_logs may be cached (see log_cache.h).
+    QSO identifiers are relative to the first QSO line in the directory.
+*/
+
+class contest_logs
+{
+protected:
+
+  call_table             _calls       { };      ///< all the calls in the logs, in order of first appearance
+  std::vector<uint32_t>  _group_log   { };      ///< index of the log file, per group
+  std::vector<CALL_ID>   _group_tcall { };      ///< tcall, per group
+  std::vector<uint32_t>  _group_end   { };      ///< index in _qsos one past the group's last QSO, per group
+  std::vector<small_qso> _qsos        { };      ///< the QSOs, group by group, each group in the order of the lines in the log
+  int                    _n_qso_lines { 0 };    ///< number of QSO lines, valid or not
+
+  std::array<int, static_cast<size_t>(QSO_REJECT::N_REASONS)> _rejects { };     ///< number of lines rejected, for each reason
+
+/*! \brief          Add the QSOs of a log
+    \param  n       index of the log in the directory
+    \param  log     the parsed log
+*/
+  void add_log(const size_t n, parsed_log&& log);
+
+public:
+
+/// default constructor
+  contest_logs(void) = default;
+
+/*! \brief              Constructor
+    \param  filenames   names of the files that contain the logs
+    \param  t_start     time of the start of the contest
+    \param  t_end       one second past the end of the contest
+    \param  pool        pool on which to parse the logs
+    \param  timer       timer of the stage, which is charged for the parsing and merging
+
+    The logs are parsed in parallel, and merged in the order of <i>filenames</i>.
+    Any messages about rejected lines are displayed on cerr, in the same order.
+*/
+  contest_logs(const std::vector<std::string>& filenames, const time_t t_start, const time_t t_end, thread_pool& pool, stage_timer& timer);
+
+  READ(calls);                              ///< all the calls in the logs
+  READ(qsos);                               ///< the QSOs, group by group
+  READ_AND_WRITE(n_qso_lines);              ///< number of QSO lines, valid or not
+  READ_AND_WRITE(rejects);                  ///< number of lines rejected, for each reason
+
+/*! \brief          Intern a call
+    \param  call    call to intern
+    \return         the identifier of <i>call</i>
+*/
+  inline CALL_ID intern(const std::string_view call)
+    { return _calls.id(call); }
+
+/*! \brief              Append a group of QSOs
+    \param  log_index   index of the log file that contains the QSOs
+    \param  tcall       the tcall of all the QSOs
+    \param  qsos        the QSOs, in the order of the lines in the log
+*/
+  void add_group(const uint32_t log_index, const CALL_ID tcall, const std::vector<small_qso>& qsos);
+
+/// release the QSOs and the groups, keeping the calls, the number of QSO lines and the rejects
+  void release_qsos(void);
+
+/// the number of groups
+  inline size_t n_groups(void) const
+    { return _group_end.size(); }
+
+/// the index of the log file of a group
+  inline uint32_t group_log(const size_t g) const
+    { return _group_log[g]; }
+
+/// the tcall of a group
+  inline CALL_ID group_tcall(const size_t g) const
+    { return _group_tcall[g]; }
+
+/// the QSOs of a group
+  inline std::span<const small_qso> group_qsos(const size_t g) const
+    { const uint32_t first { (g == 0) ? 0 : _group_end[g - 1] };
+
+      return std::span<const small_qso> { _qsos }.subspan(first, _group_end[g] - first);
+    }
+};
+
+// -----------  band_log  ----------------
+
+/*! \class  band_log
+    \brief  Columnar store of all the QSOs on a single band
+
+    Each QSO is a row. Rows are in chronological order and, within each minute, in order of frequency;
+    so the rows for a minute, and for a range of frequencies within a minute, are ranges of rows. This
+    forms a time x frequency grid. The rows for each tcall (in chronological order), and the rows
+    for each minute whose tcall's frequency information cannot be trusted, are also available.
+*/
+
+class band_log
+{
+protected:
+
+  HF_BAND _band { HF_BAND::BAD };           ///< band
+
+  std::vector<time_t>  _time     { };       ///< time of the QSO, per row
+  std::vector<int>     _rel_mins { };       ///< relative minutes from the start of the contest, per row
+  std::vector<int>     _qrg      { };       ///< frequency in kHz, per row
+  std::vector<CALL_ID> _tcall    { };       ///< transmitted call, per row
+  std::vector<CALL_ID> _rcall    { };       ///< received call, per row
+  std::vector<int>     _id       { };       ///< unique QSO identifier, per row
+
+  std::vector<packed_call> _packed_tcall { };   ///< transmitted call, packed for fast comparison, per row
+
+  std::vector<uint32_t> _minute_start { };  ///< first row for each minute; the final element is the number of rows
+  std::vector<uint32_t> _tcall_start  { };  ///< for each tcall, the index of its first row in _tcall_rows; the final element is the number of rows
+  std::vector<uint32_t> _tcall_rows   { };  ///< rows, grouped by tcall, and in chronological order within each group
+
+  std::vector<uint32_t> _unreliable_start { };  ///< first index in _unreliable_rows for each minute; the final element is the number of such rows
+  std::vector<uint32_t> _unreliable_rows  { };  ///< rows whose tcall has untrustworthy frequency information, in chronological order
+
+  call_id_set _tcalls { };                  ///< all the tcalls on the band
+
+public:
+
+/// default constructor
+  band_log(void) = default;
+
+/*! \brief                  Constructor
+    \param  b               band
+    \param  qsos            all the QSOs on band <i>b</i>, in any order
+    \param  max_rel_mins                the number of minutes in the contest - 1
+    \param  calls                       table in which the calls are interned
+    \param  calls_with_no_freq_info     entrants whose logged frequency information is useless
+    \param  calls_with_poor_freq_info   entrants whose logged frequency information is untrustworthy
+*/
+  band_log(const HF_BAND b, const std::vector<const small_qso*>& qsos, const int max_rel_mins, const call_table& calls,
+           const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info);
+
+  READ(band);                               ///< band
+  READ(tcalls);                             ///< all the tcalls on the band
+
+/// the number of rows
+  inline uint32_t size(void) const
+    { return static_cast<uint32_t>(_id.size()); }
+
+/// is the store empty?
+  inline bool empty(void) const
+    { return _id.empty(); }
+
+/// the values in a row
+  inline time_t  time(const uint32_t row)     const { return _time[row]; }
+  inline int     rel_mins(const uint32_t row) const { return _rel_mins[row]; }
+  inline int     qrg(const uint32_t row)      const { return _qrg[row]; }
+  inline CALL_ID tcall(const uint32_t row)    const { return _tcall[row]; }
+  inline CALL_ID rcall(const uint32_t row)    const { return _rcall[row]; }
+  inline int     id(const uint32_t row)       const { return _id[row]; }
+
+  inline const packed_call& packed_tcall(const uint32_t row) const { return _packed_tcall[row]; }
+
+/*! \brief          The packed tcalls of a range of rows
+    \param  first   first row in the range
+    \param  last    one past the last row in the range
+    \return         the packed tcalls of the rows from <i>first</i> to <i>last</i> - 1
+*/
+  inline std::span<const packed_call> packed_tcalls(const uint32_t first, const uint32_t last) const
+    { return { _packed_tcall.data() + first, _packed_tcall.data() + last }; }
+
+/*! \brief      The first row for a minute
+    \param  m   relative minute, which may be one past the last minute in the contest
+    \return     the first row whose time is <i>m</i> or later
+*/
+  inline uint32_t minute_start(const int m) const
+    { return _minute_start.at(m); }
+
+/*! \brief              The rows in a minute within a range of frequencies
+    \param  m           relative minute
+    \param  low_qrg     lowest frequency, in kHz
+    \param  high_qrg    highest frequency, in kHz
+    \return             the first row and one past the last row in minute <i>m</i> whose frequency lies in the range [<i>low_qrg</i>, <i>high_qrg</i>]
+*/
+  std::pair<uint32_t, uint32_t> qrg_rows(const int m, const int low_qrg, const int high_qrg) const;
+
+/*! \brief      The rows in a minute whose tcall has untrustworthy frequency information
+    \param  m   relative minute
+    \return     the rows in minute <i>m</i> whose tcall is in either <i>calls_with_no_freq_info</i> or <i>calls_with_poor_freq_info</i>
+*/
+  inline std::span<const uint32_t> unreliable_rows(const int m) const
+    { return { _unreliable_rows.data() + _unreliable_start.at(m), _unreliable_rows.data() + _unreliable_start.at(m + 1) }; }
+
+/*! \brief          The rows belonging to a tcall
+    \param  tcall   target tcall
+    \return         the rows whose tcall is <i>tcall</i>, in chronological order
+*/
+  inline std::span<const uint32_t> tcall_rows(const CALL_ID tcall) const
+    { return ( (tcall + 1 < _tcall_start.size()) ? std::span<const uint32_t> { _tcall_rows.data() + _tcall_start[tcall], _tcall_rows.data() + _tcall_start[tcall + 1] }
+                                                 : std::span<const uint32_t> { } ); }
+
+/*! \brief          Convert a row to a printable string
+    \param  row     target row
+    \param  calls   table in which the calls are interned
+    \return         human-readable description of the QSO in row <i>row</i>
+*/
+  std::string to_string(const uint32_t row, const call_table& calls) const;
+};
 
 /*! \brief                              Does a call's log have valid frequency information?
     \param  call                        target call
@@ -209,35 +808,90 @@ std::ostream& operator<<(std::ostream& ost, const small_qso& sq)
     \return                             whether <i>call<i/> has a log with valid frequency information
     
 */
-inline bool call_has_good_freq_info(const std::string& call, const std::unordered_set<std::string>& calls_with_no_freq_info, const std::unordered_set<std::string>& calls_with_poor_freq_info)
+inline bool call_has_good_freq_info(const CALL_ID call, const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info)
   { return (!calls_with_no_freq_info.contains(call) and !calls_with_poor_freq_info.contains(call)); }
 
-/*! \brief          Given a container of calls, for each one return a list of possible busts from the container
-    \param  calls   container of calls
-    \return         for each call in <i>calls</i> a set of possible busts of the call from those in <i>calls</i>
-    
-    If there are no possible busts for a call, no entry is placed into the map
+// -----------  run_segments  ----------------
+
+/*! \class  run_segments
+    \brief  For each entrant on a band, the periods during which it was on a particular frequency
+
+    For an entrant whose frequency information is good, a segment is a sequence of consecutive QSOs in its own log on the
+    same frequency, with no gap between them of more than RUN_SEGMENT_GAP minutes; so a window of +/- CLOCK_SKEW minutes
+    that overlaps a segment contains at least one of its QSOs. For an entrant whose frequency information cannot be trusted,
+    each QSO in which another station logged the entrant is a segment, which also records that station.
+
+    The segments of each entrant are in chronological order, and do not overlap.
 */
-template <typename C>
-  requires is_string<typename C::value_type>
-std::unordered_map<std::string /* call */, std::unordered_set<std::string> /* possible_busts */> possible_busts(const C& calls)
-{ std::unordered_map<std::string, std::unordered_set<std::string>> rv { };
 
-  for (auto it1 { calls.cbegin() }; it1 != calls.cend(); ++it1)
-  { const std::string& call1 { *it1 };
+class run_segments
+{
+protected:
 
-    for (auto it2 { next(it1) }; it2 != calls.cend(); ++it2)  
-    { const std::string& call2 { *it2 };
-    
-      if (is_bust(call1, call2))
-      { rv[call1] += call2;
-        rv[call2] += call1;         // busting is symmetrical
-      }
-    }
-  }
-  
-  return rv;
-}
+  std::vector<int>      _first_mins { };    ///< relative minutes of the first QSO, per segment
+  std::vector<int>      _last_mins  { };    ///< relative minutes of the last QSO, per segment
+  std::vector<int>      _qrg        { };    ///< frequency in kHz, per segment
+  std::vector<CALL_ID>  _logger     { };    ///< the station that logged the QSOs, if not the entrant itself; otherwise NO_CALL; per segment
+  std::vector<uint32_t> _call_start { };    ///< for each call, the index of its first segment; the final element is the number of segments
+
+  int _maximum_minutes { 0 };               ///< the number of minutes in the contest - 1
+
+public:
+
+/// default constructor
+  run_segments(void) = default;
+
+/*! \brief                              Constructor
+    \param  bl                          all the QSOs on a band
+    \param  max_rel_mins                the number of minutes in the contest - 1
+    \param  n_calls                     the number of calls in the call table
+    \param  calls_with_no_freq_info     the calls that have no reliable frequency info in the log
+    \param  calls_with_poor_freq_info   entrants whose logged frequency information is untrustworthy
+    \param  entrants                    the entrants whose segments are needed
+
+    Only the segments of <i>entrants</i> are built; the other calls have none
+*/
+  run_segments(const band_log& bl, const int max_rel_mins, const size_t n_calls, const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info,
+               const call_id_set& entrants);
+
+/// the number of segments
+  inline size_t size(void) const
+    { return _qrg.size(); }
+
+/*! \brief                  Determine whether a station is running at a particular time and on a particular frequency
+    \param  call            call of the target station
+    \param  rel_mins        target relative minutes
+    \param  qrg             target frequency, in kHz
+    \param  ignore_call     ignore QSOs logged by this call (typically the station that reported working <i>call</i> at this time and frequency)
+    \return                 whether <i>call</i> is an entrant that appears to have been running within CLOCK_SKEW minutes of <i>rel_mins</i>, within FREQ_SKEW kHz of <i>qrg</i>
+
+    <i>ignore_call</i> applies only to entrants whose frequency information cannot be trusted, as only they are found in the logs of other stations
+*/
+  bool is_running(const CALL_ID call, const int rel_mins, const int qrg, const CALL_ID ignore_call) const;
+};
+
+// -----------  diagnostics  ----------------
+
+/*! \class  diagnostics
+    \brief  Policy that selects, at compile time, the diagnostic output of the processing of a band
+
+    The processing is instantiated once for each combination of -v and -tr, so that the instantiation
+    without either contains no diagnostic tests at all
+*/
+
+template <bool VERBOSE, bool TRACING>
+class diagnostics
+{
+public:
+
+  static constexpr bool verbose { VERBOSE };    ///< whether to produce verbose output
+  static constexpr bool tracing { TRACING };    ///< whether to report on the processing of the traced call
+};
+
+using QUIET_DIAGNOSTICS         = diagnostics<false, false>;      ///< neither -v nor -tr
+using VERBOSE_DIAGNOSTICS       = diagnostics<true,  false>;      ///< -v
+using TRACE_DIAGNOSTICS         = diagnostics<false, true>;       ///< -tr
+using VERBOSE_TRACE_DIAGNOSTICS = diagnostics<true,  true>;       ///< -v and -tr
 
 // -----------  contest_parameters  ----------------
 
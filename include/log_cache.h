@@ -0,0 +1,86 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   log_cache.h
+
+    Functions to write and read files that cache the logs of a contest, so that the logs need not be parsed again,
+    and files that cache the calls derived from them, so that an unchanged contest need not be processed again
+*/
+
+#ifndef LOG_CACHE_H
+#define LOG_CACHE_H
+
+#include "drscp.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+/*! \brief                  Obtain the name of the cache file for a contest directory
+    \param  cache_dirname   directory that holds the cache files
+    \param  dirname         directory that contains the logs
+    \return                 name of the cache file for <i>dirname</i>
+*/
+std::string log_cache_filename(const std::string& cache_dirname, const std::string& dirname);
+
+/*! \brief              Obtain the key that identifies the inputs from which the logs of a contest are read
+    \param  cp          directory, start and duration
+    \param  filenames   names of the files in the directory
+    \return             key comprising the contest period and the name, size and mtime of each file
+
+    A cache file may be used only if its key matches the current key
+*/
+std::string log_cache_key(const contest_parameters& cp, const std::vector<std::string>& filenames);
+
+/*! \brief                  Write logs to a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the inputs
+    \param  logs            the logs to write
+    \return                 whether the file was written successfully
+
+    The file is written under a temporary name and then renamed, so a partially-written file is never read
+*/
+bool write_log_cache(const std::string& cache_filename, const std::string& key, const contest_logs& logs);
+
+/*! \brief                  Read logs from a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the current inputs
+    \return                 the logs, if <i>cache_filename</i> exists, is well formed, and has the key <i>key</i>
+*/
+std::optional<contest_logs> read_log_cache(const std::string& cache_filename, const std::string& key);
+
+/*! \brief                  Obtain the name of the file that caches the calls derived from a contest directory
+    \param  cache_dirname   directory that holds the cache files
+    \param  dirname         directory that contains the logs
+    \param  parameters      short description of the parameters that affect the calls
+    \return                 name of the file that caches the calls for <i>dirname</i> and <i>parameters</i>
+
+    Each set of parameters has its own file, so that runs with different parameters do not displace one another's results
+*/
+std::string call_map_cache_filename(const std::string& cache_dirname, const std::string& dirname, const std::string& parameters);
+
+/*! \brief                  Write calls to a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the inputs and the parameters that affect the calls
+    \param  calls           the calls, with their counts
+    \return                 whether the file was written successfully
+
+    The file is written under a temporary name and then renamed, so a partially-written file is never read
+*/
+bool write_call_map_cache(const std::string& cache_filename, const std::string& key, const collated_calls& calls);
+
+/*! \brief                  Read calls from a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the current inputs and parameters
+    \return                 the calls, if <i>cache_filename</i> exists, is well formed, and has the key <i>key</i>
+*/
+std::optional<collated_calls> read_call_map_cache(const std::string& cache_filename, const std::string& key);
+
+#endif    // LOG_CACHE_H
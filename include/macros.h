@@ -22,10 +22,13 @@
 #include <experimental/functional>  // for not_fn
 #include <future>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
 #include <numeric>
+#include <optional>
 #include <queue>
+#include <ranges>
 #include <set>
 #include <string>
 #include <experimental/string_view>
@@ -1860,34 +1863,56 @@ std::vector<T> PAIRWISE_SUM(const std::vector<T>& v1, const std::vector<T>& v2)
   return rv;
 }
 
-/*! \brief  Given a container of values, return the value at a given percentage point in an ordered sequence
+/*! \brief          Given a container of values, return the values at given percentage points in an ordered sequence
     \param  values  container of values
-    \param  pc      percentage point
-    \return         the value at the <i>pc</i>th percentage point
+    \param  pcs     percentage points
+    \return         the value at each of the <i>pcs</i>th percentage points
+
+    The value for 100% is the smallest value, so that all values match; for 0%, or for a point that lies beyond the
+    largest value, it is the largest possible value of the type, so that (in practice) none match. The values are
+    copied once, and each percentage point is selected in linear time, without sorting.
 */
 template <typename C>
-typename C::value_type value_line(const C& values, const int pc)
-{ if (values.empty())
-    return std::numeric_limits<typename C::value_type>::max();
-
-  std::vector<typename C::value_type> ordered_vector;
-  ordered_vector.reserve(values.size());
+std::vector<typename C::value_type> value_lines(const C& values, const std::vector<int>& pcs)
+{ using V = typename C::value_type;
 
-  FOR_ALL(values, [&ordered_vector] (const auto& v) { ordered_vector += v; });
+  std::vector<V> rv;
+  rv.reserve(pcs.size());
 
-  SORT(ordered_vector);
+  if (values.empty())
+  { rv.resize(pcs.size(), std::numeric_limits<V>::max());
+    return rv;
+  }
 
-  const int clamped_pc { std::clamp(pc, 0, 100) };
+  std::vector<V> partitioned_vector { values.begin(), values.end() };
 
-  if (clamped_pc == 100)
-    return (ordered_vector[0]);     // all match
+  for (const int pc : pcs)
+  { const int clamped_pc { std::clamp(pc, 0, 100) };
 
-  if (clamped_pc == 0)
-    return ordered_vector[ordered_vector.size() + 1];   // none match
+    if (clamped_pc == 100)
+      rv += *std::min_element(partitioned_vector.begin(), partitioned_vector.end());      // all match
+    else
+    { const size_t idx { static_cast<size_t>((values.size() * (100 - static_cast<float>(clamped_pc)) / 100) + 0.5) };
 
-  const size_t idx { static_cast<size_t>((values.size() * (100 - static_cast<float>(clamped_pc)) / 100) + 0.5) };
+      if ( (clamped_pc == 0) or (idx >= partitioned_vector.size()) )
+        rv += std::numeric_limits<V>::max();                                            // none match
+      else
+      { std::nth_element(partitioned_vector.begin(), partitioned_vector.begin() + idx, partitioned_vector.end());
+        rv += partitioned_vector[idx];
+      }
+    }
+  }
 
-  return ordered_vector.at(idx);
+  return rv;
 }
 
+/*! \brief  Given a container of values, return the value at a given percentage point in an ordered sequence
+    \param  values  container of values
+    \param  pc      percentage point
+    \return         the value at the <i>pc</i>th percentage point
+*/
+template <typename C>
+inline typename C::value_type value_line(const C& values, const int pc)
+  { return value_lines(values, { pc })[0]; }
+
 #endif    // MACROS_H
@@ -0,0 +1,193 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   scp_file.h
+
+    Functions to generate the output files, in text SCP/XSCP and in binary XSCP format, and a class to read binary XSCP files
+*/
+
+#ifndef SCP_FILE_H
+#define SCP_FILE_H
+
+#include "binary_io.h"
+#include "diskfile.h"
+#include "drscp.h"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*! \brief              Generate the text of an SCP or XSCP file
+    \param  calls       the calls, with their counts
+    \param  val_limit   the least count of a call to be included
+    \param  xscp        whether to generate XSCP output, which includes the count on each line
+    \return             the contents of the file, one call per line, in callsign order
+*/
+std::string scp_text(const collated_calls& calls, const int val_limit, const bool xscp);
+
+/*! \brief                  Generate the contents of a binary XSCP file
+    \param  calls           the calls, with their counts
+    \param  val_limit       the least count of a call to be included
+    \param  substring_index whether to include the trigram index, with which the calls that contain a string are found quickly
+    \return                 the contents of the file
+
+    The format is described in scp_file.cpp
+*/
+std::string binary_xscp(const collated_calls& calls, const int val_limit, const bool substring_index = false);
+
+/*! \brief          Append calls and their counts to a buffer
+    \param  bw      buffer to which the calls are appended
+    \param  calls   the calls, with their counts
+
+    The calls begin and end on an eight-byte boundary
+*/
+void put_calls(binary_writer& bw, const collated_calls& calls);
+
+/*! \brief          Read calls and their counts from a buffer
+    \param  br      buffer from which the calls are read, positioned as after put_calls() (that is, on an eight-byte boundary)
+    \return         the calls, if they are well formed
+*/
+std::optional<collated_calls> get_calls(binary_reader& br);
+
+/// the order of the calls returned by a query of a binary XSCP file
+enum class XSCP_ORDER { CALLSIGN,           ///< callsign order
+                        COUNT               ///< greatest count first; calls with the same count in callsign order
+                      };
+
+// -----------  binary_xscp_file  ----------------
+
+/*! \class  binary_xscp_file
+    \brief  A binary XSCP file, mapped into memory
+
+    The calls are in callsign order. Nothing is copied or parsed when the file is opened: calls are returned as views of the mapping.
+    If the file has a substring index, the calls that contain a string of at least three characters are found from the postings
+    of the string's rarest trigram; otherwise every call is examined.
+*/
+
+class binary_xscp_file
+{
+protected:
+
+  memory_mapped_file         _file;                 ///< the mapped file
+  std::span<const uint32_t>  _call_ends   { };      ///< the end offset of each call in _call_chars
+  std::span<const int32_t>   _counts      { };      ///< the count of each call
+  std::string_view           _call_chars  { };      ///< the characters of all the calls
+  std::span<const uint32_t>  _first_index { };      ///< for each collation byte, the index of the first call whose first character has that byte or later
+
+  bool                       _indexed       { false };  ///< whether the file has a substring index
+  std::span<const uint32_t>  _trigram_keys  { };        ///< the key of each trigram that appears in a call, in increasing order
+  std::span<const uint32_t>  _posting_ends  { };        ///< the end offset of the postings of each trigram in _postings
+  std::span<const uint32_t>  _postings      { };        ///< for each trigram, the indices of the calls that contain it, in increasing order
+
+/*! \brief          Obtain the calls that contain a particular trigram
+    \param  key     key of the trigram
+    \return         the indices of the calls that contain the trigram whose key is <i>key</i>, in increasing order
+*/
+  std::span<const uint32_t> _trigram_postings(const uint32_t key) const;
+
+public:
+
+/*! \brief              Constructor
+    \param  filename    name of the file
+
+    Throws diskfile_exception if the file cannot be mapped or is not a well-formed binary XSCP file
+*/
+  explicit binary_xscp_file(const std::string& filename);
+
+/// the number of calls
+  inline size_t size(void) const
+    { return _counts.size(); }
+
+/*! \brief      Obtain a call
+    \param  n   index of the call
+    \return     call number <i>n</i>, in callsign order
+*/
+  inline std::string_view call(const size_t n) const
+    { const uint32_t first { (n == 0) ? 0 : _call_ends[n - 1] };
+
+      return _call_chars.substr(first, _call_ends[n] - first);
+    }
+
+/*! \brief      Obtain the count of a call
+    \param  n   index of the call
+    \return     the count of call number <i>n</i>
+*/
+  inline int count(const size_t n) const
+    { return _counts[n]; }
+
+/*! \brief          Obtain the calls that begin with a particular string
+    \param  prefix  the string
+    \return         the first index, and one past the last index, of the calls that begin with <i>prefix</i>
+*/
+  std::pair<size_t, size_t> calls_with_prefix(const std::string_view prefix) const;
+
+/*! \brief          Obtain the count of a particular call
+    \param  target  call to find
+    \return         the count of <i>target</i>, if it is present
+*/
+  std::optional<int> find(const std::string_view target) const;
+
+/// does the file have a substring index?
+  inline bool indexed(void) const
+    { return _indexed; }
+
+/*! \brief              Obtain the calls that contain a particular string
+    \param  fragment    the string
+    \param  order       the order of the returned calls
+    \return             the indices of the calls that contain <i>fragment</i>, in the order <i>order</i>
+*/
+  std::vector<size_t> calls_containing(const std::string_view fragment, const XSCP_ORDER order = XSCP_ORDER::CALLSIGN) const;
+};
+
+// -----------  partial_calls  ----------------
+
+/*! \class  partial_calls
+    \brief  The calls from some of the contests in a list, to be merged with the calls from the others
+
+    Different subsets of the contests may be processed on different machines; merging the partial files
+    gives the same calls as processing all the contests at once
+*/
+
+class partial_calls
+{
+protected:
+
+  std::string              _parameters  { };    ///< the parameters that affect the calls; partials may be merged only if their parameters are the same
+  std::vector<std::string> _directories { };    ///< the directories of the contests
+  collated_calls           _calls       { };    ///< the calls, with their counts
+
+public:
+
+/*! \brief                  Constructor
+    \param  parameters      the parameters that affect the calls
+    \param  directories     the directories of the contests
+    \param  calls           the calls from the contests, with their counts
+*/
+  partial_calls(const std::string& parameters, const std::vector<std::string>& directories, collated_calls&& calls);
+
+/*! \brief              Constructor from a file
+    \param  filename    name of the file
+
+    Throws diskfile_exception if the file cannot be mapped or is not a well-formed partial file
+*/
+  explicit partial_calls(const std::string& filename);
+
+  READ(parameters);                     ///< the parameters that affect the calls
+  READ(directories);                    ///< the directories of the contests
+  READ(calls);                          ///< the calls, with their counts
+
+/// the contents of a partial file that holds the object
+  std::string contents(void) const;
+};
+
+#endif    // SCP_FILE_H
@@ -0,0 +1,201 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   stats.h
+
+    Classes for recording the time taken by, and the numbers of QSOs processed in, each stage of the processing
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*! \brief  Obtain the CPU time used so far by the calling thread
+    \return the CPU time used by the calling thread, in nanoseconds
+*/
+int64_t thread_cpu_ns(void);
+
+// -----------  stage_stats  ----------------
+
+/*! \class  stage_stats
+    \brief  The statistics of a single stage
+*/
+
+class stage_stats
+{
+protected:
+
+  std::string _directory;       ///< directory of the contest
+  std::string _band;            ///< band; empty if the stage is not performed per band
+  std::string _stage;           ///< name of the stage
+  double      _wall_secs;       ///< elapsed time, in seconds
+  double      _cpu_secs;        ///< CPU time, in seconds
+  int64_t     _n_qsos;          ///< number of QSOs processed by the stage
+  int64_t     _n_removed;       ///< number of QSOs removed by the stage
+
+public:
+
+/// constructor
+  stage_stats(const std::string& directory, const std::string& band, const std::string& stage, const double wall_secs, const double cpu_secs,
+              const int64_t n_qsos, const int64_t n_removed) :
+    _directory(directory),
+    _band(band),
+    _stage(stage),
+    _wall_secs(wall_secs),
+    _cpu_secs(cpu_secs),
+    _n_qsos(n_qsos),
+    _n_removed(n_removed)
+  { }
+
+  READ(directory);              ///< directory of the contest
+  READ(band);                   ///< band; empty if the stage is not performed per band
+  READ(stage);                  ///< name of the stage
+  READ(wall_secs);              ///< elapsed time, in seconds
+  READ(cpu_secs);               ///< CPU time, in seconds
+  READ(n_qsos);                 ///< number of QSOs processed by the stage
+  READ(n_removed);              ///< number of QSOs removed by the stage
+};
+
+// -----------  stats_recorder  ----------------
+
+/*! \class  stats_recorder
+    \brief  Thread-safe accumulator of the statistics of stages
+
+    When disabled, nothing is recorded
+*/
+
+class stats_recorder
+{
+protected:
+
+  bool                     _enabled { false };  ///< whether statistics are to be recorded
+  mutable std::mutex       _mtx     { };        ///< protects _stages
+  std::vector<stage_stats> _stages  { };        ///< the statistics of each stage, in the order in which the stages finished
+
+public:
+
+  READ_AND_WRITE(enabled);                      ///< whether statistics are to be recorded
+
+/*! \brief      Add the statistics of a stage
+    \param  ss  the statistics
+*/
+  void operator+=(stage_stats&& ss);
+
+/*! \brief              Obtain the total CPU time of the stages of a directory that have been recorded
+    \param  directory   directory of the contest
+    \return             the sum of the CPU times of the stages of <i>directory</i>, in seconds
+*/
+  double cpu_secs(const std::string& directory) const;
+
+/*! \brief  Obtain all the statistics, in CSV format
+    \return the statistics, one stage per line, after a header line
+*/
+  std::string csv(void) const;
+};
+
+// -----------  stage_timer  ----------------
+
+/*! \class  stage_timer
+    \brief  Measure the elapsed and CPU time of a stage
+
+    A stage that runs entirely on one thread is timed from construction (or restart()) to record(). A stage that
+    submits tasks to a thread pool is marked as parallel, because a thread that waits for a task may meanwhile run
+    unrelated tasks; the CPU time of such a stage is the sum of the CPU time of the functions run through charge().
+*/
+
+class stage_timer
+{
+protected:
+
+  stats_recorder&                       _recorder;                  ///< where the statistics are recorded
+  const bool                            _parallel;                  ///< whether the stage runs on more than one thread
+  std::chrono::steady_clock::time_point _wall_start   { };          ///< time at which the stage started
+  int64_t                               _cpu_start    { 0 };        ///< CPU time of the constructing thread when the stage started, in nanoseconds
+  std::atomic<int64_t>                  _charged_cpu  { 0 };        ///< CPU time charged by charge(), in nanoseconds
+
+public:
+
+/*! \brief              Constructor
+    \param  recorder    where the statistics are recorded; if it is disabled, the timer does nothing
+    \param  parallel    whether the stage runs on more than one thread
+*/
+  explicit stage_timer(stats_recorder& recorder, const bool parallel = false);
+
+/// start timing a new stage
+  void restart(void);
+
+/// the elapsed time since the stage started, in seconds
+  double wall_secs(void) const;
+
+/*! \brief      Run a function, charging its CPU time to the stage
+    \param  f   function to run on the calling thread
+    \return     the result of <i>f</i>
+
+    <i>f</i> must not wait for other tasks
+*/
+  template <typename F>
+  auto charge(F&& f) -> std::invoke_result_t<F>
+  { if (!_recorder.enabled())
+      return std::forward<F>(f)();
+
+    struct charger                      // charges the CPU time on destruction, so that f may return void
+    { stage_timer& timer;
+      int64_t      start;
+
+      ~charger(void)
+        { timer._charged_cpu += (thread_cpu_ns() - start); }
+    } c { *this, thread_cpu_ns() };
+
+    return std::forward<F>(f)();
+  }
+
+/*! \brief      Run a function without counting its CPU time as that of the stage
+    \param  f   function to run on the thread that constructed the timer
+    \return     the result of <i>f</i>
+
+    Typically <i>f</i> waits for tasks whose CPU time is charged through charge(); while it waits, the thread
+    may run some of those tasks, or unrelated ones, which would otherwise be counted twice or wrongly
+*/
+  template <typename F>
+  auto uncharged(F&& f) -> std::invoke_result_t<F>
+  { if (!_recorder.enabled() or _parallel)         // the CPU time of the constructing thread is not counted anyway
+      return std::forward<F>(f)();
+
+    struct discharger                   // removes the CPU time on destruction, so that f may return void
+    { stage_timer& timer;
+      int64_t      start;
+
+      ~discharger(void)
+        { timer._charged_cpu -= (thread_cpu_ns() - start); }
+    } d { *this, thread_cpu_ns() };
+
+    return std::forward<F>(f)();
+  }
+
+/*! \brief              Record the statistics of the stage
+    \param  directory   directory of the contest
+    \param  band        band; empty if the stage is not performed per band
+    \param  stage       name of the stage
+    \param  n_qsos      number of QSOs processed by the stage
+    \param  n_removed   number of QSOs removed by the stage
+*/
+  void record(const std::string& directory, const std::string& band, const std::string& stage, const int64_t n_qsos, const int64_t n_removed = 0);
+};
+
+#endif    // STATS_H
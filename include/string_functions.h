@@ -258,7 +258,7 @@ inline bool contains(const std::string& s, const char c)
     \param  str     string to test
     \return         whether <i>str</i> contains any letters
 */
-bool contains_letter(const std::string& str);
+bool contains_letter(const std::string_view str);
 
 /*! \brief          Does a string contain any upper case letters?
     \param  str     string to test
@@ -271,7 +271,7 @@ inline bool contains_upper_case_letter(const std::string& str)
     \param  str     string to test
     \return         whether <i>str</i> contains any digits
 */
-bool contains_digit(const std::string& str);
+bool contains_digit(const std::string_view str);
 
 /*! \brief          Does a string contain only digits?
     \param  str     string to test
@@ -897,6 +897,21 @@ bool is_legal_value(const std::string& value, const std::string& legal_values, c
 */
 bool compare_calls(const std::string& call1, const std::string& call2);
 
+/*! \brief          Obtain the collation key of a call
+    \param  call    call
+    \return         key whose ordinary (byte by byte) comparison with the key of another call reproduces callsign sort order
+
+    The key has the same length as <i>call</i>; each character is translated through a fixed table. For calls
+    made from CALLSIGN_CHARS, <i>key(call1) < key(call2)</i> if and only if <i>compare_calls(call1, call2)</i>.
+*/
+std::string call_collation_key(const std::string_view call);
+
+/*! \brief          Obtain a call from its collation key
+    \param  key     collation key
+    \return         the call whose collation key is <i>key</i>
+*/
+std::string call_from_collation_key(const std::string_view key);
+
 /*! \brief          Is the value of one mult earlier than another?
     \param  mult1   first mult value
     \param  mult2   second mult value
@@ -0,0 +1,152 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   thread_pool.h
+
+    A work-stealing pool of threads
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// -----------  thread_pool  ----------------
+
+/*! \class  thread_pool
+    \brief  A fixed set of threads, each with its own queue of tasks, that steal work from one another when idle
+
+    A task submitted from one of the pool's threads goes onto that thread's own queue, and is taken
+    from the back (most recent first); a task submitted from elsewhere is distributed round robin.
+    An idle thread steals from the front of the other queues. A thread that waits for a result
+    (see wait()) runs queued tasks while it waits, so tasks may safely wait for the tasks that they submit.
+*/
+
+class thread_pool
+{
+protected:
+
+  using TASK = std::function<void(void)>;       ///< type of a queued task
+
+/// a queue of tasks belonging to one thread
+  struct task_queue
+  { std::mutex       mtx   { };     ///< mutex for <i>tasks</i>
+    std::deque<TASK> tasks { };     ///< queued tasks
+  };
+
+  std::vector<std::unique_ptr<task_queue>> _queues  { };    ///< one queue for each thread
+  std::vector<std::thread>                 _threads { };    ///< the threads
+
+  std::mutex              _mtx        { };      ///< mutex for the following three values and for _cv
+  std::condition_variable _cv         { };      ///< signalled when a task is queued, when a task completes, and when the pool is stopping
+  size_t                  _n_queued   { 0 };    ///< number of tasks in all the queues
+  uint64_t                _n_finished { 0 };    ///< number of tasks that have completed
+  bool                    _stopping   { false };///< whether the pool is being destroyed
+
+  std::atomic<size_t>     _next_queue { 0 };    ///< queue for the next task submitted from outside the pool
+
+/*! \brief          Add a task to a queue
+    \param  task    task to add
+*/
+  void _push(TASK&& task);
+
+/*! \brief      Run one queued task, if there is one
+    \return     whether a task was run
+*/
+  bool _run_one(void);
+
+/*! \brief          Main loop of a thread
+    \param  index   index of the thread in the pool
+*/
+  void _work(const size_t index);
+
+public:
+
+/*! \brief              Constructor
+    \param  n_threads   number of threads in the pool; if zero, one is used
+*/
+  explicit thread_pool(const unsigned int n_threads);
+
+/// no copying
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+/// destructor; runs any tasks still queued, then joins the threads
+  ~thread_pool(void);
+
+/// the number of threads
+  inline size_t size(void) const
+    { return _threads.size(); }
+
+/*! \brief      Submit a task
+    \param  f   function to run, taking no arguments
+    \return     future for the value returned by <i>f</i>
+*/
+  template <typename F>
+  auto submit(F&& f) -> std::future<std::invoke_result_t<F>>
+  { using R = std::invoke_result_t<F>;
+
+    auto task_p { std::make_shared<std::packaged_task<R(void)>>(std::forward<F>(f)) };   // shared, because std::function must be copyable
+    auto rv     { task_p->get_future() };
+
+    _push( [task_p] (void) { (*task_p)(); } );
+
+    return rv;
+  }
+
+/*! \brief          Wait until a condition holds, running queued tasks while waiting
+    \param  pred    the condition
+
+    <i>pred</i> is tested whenever a task completes; so it must become true only as a result of the completion of a task in the pool
+*/
+  template <typename P>
+  void wait_until(P&& pred)
+  { while (true)
+    { if (pred())
+        return;
+
+      if (_run_one())
+        continue;
+
+      std::unique_lock lock { _mtx };
+
+      const uint64_t n_finished { _n_finished };
+
+      if (pred())
+        return;
+
+      _cv.wait(lock, [this, n_finished] (void) { return (_n_queued != 0) or (_n_finished != n_finished); });
+    }
+  }
+
+/*! \brief          Wait for a result, running queued tasks while waiting
+    \param  fut     future for the result
+    \return         the result
+*/
+  template <typename T>
+  T wait(std::future<T>& fut)
+  { wait_until( [&fut] (void) { return (fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready); } );
+
+    return fut.get();
+  }
+};
+
+#endif    // THREAD_POOL_H
@@ -0,0 +1,207 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   bust.cpp
+
+    Functions and classes for recognising busted calls
+*/
+
+#include "bust.h"
+#include "macros.h"
+#include "string_functions.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace std;
+
+/*  \brief          Is a copied call a bust of another call?
+    \param  call    target (correct) call
+    \param  copied  copied call
+    \return         whether <i>copied</i> is a plausible bust of <i>call</i>
+    
+    A bust is a single substitution, a single insertion or deletion, or a transposition of adjacent characters.
+    The relation is symmetrical. Does not allocate.
+*/
+bool is_bust(const string_view call, const string_view copied) noexcept
+{ const size_t call_len   { call.length() };
+  const size_t copied_len { copied.length() };
+
+  if (call_len == copied_len)
+  { size_t first { 0 };
+
+    while ( (first < call_len) and (call[first] == copied[first]) )
+      first++;
+
+    if (first == call_len)
+      return false;                // not a bust if it's copied OK
+
+    size_t last { call_len - 1 };
+
+    while (call[last] == copied[last])
+      last--;
+
+// either exactly one character differs, or two adjacent characters are inverted
+    return ( (first == last) or ( (last == first + 1) and (call[first] == copied[last]) and (call[last] == copied[first]) ) );
+  }
+
+  if ( (call_len != copied_len + 1) and (copied_len != call_len + 1) )
+    return false;                // not a bust if the lengths differ by 2 or more
+
+// lengths differ by unity; is the bust in the form of an additional character, or a missing character, somewhere in the call?
+  const string_view longer  { (call_len > copied_len) ? call : copied };
+  const string_view shorter { (call_len > copied_len) ? copied : call };
+
+  size_t posn { 0 };
+
+  while ( (posn < shorter.length()) and (longer[posn] == shorter[posn]) )
+    posn++;
+
+  return (longer.substr(posn + 1) == shorter.substr(posn));
+}
+
+// -----------  packed_call  ----------------
+
+/*! \class  packed_call
+    \brief  A call packed into sixteen bytes, so that calls may be compared a word at a time
+
+    Calls of up to fifteen characters are held inline, padded with zeroes, with the length in the
+    final byte. Longer calls, which are rare, hold a pointer to the characters instead; the
+    characters must outlive the packed_call.
+*/
+
+namespace
+{
+
+/*! \brief      The number of non-zero bytes in a word
+    \param  w   word to test
+    \return     the number of bytes in <i>w</i> that are not zero
+*/
+inline int nonzero_bytes(const uint64_t w) noexcept
+{ constexpr uint64_t LOW_7 { 0x7F7F7F7F7F7F7F7F };
+
+  const uint64_t high_bits { ((w bitand LOW_7) + LOW_7) bitor w };     // the high bit of each byte is set if and only if the byte is non-zero
+
+  return popcount(high_bits bitand compl LOW_7);
+}
+
+}
+
+/*! \brief          Is a packed copied call a bust of another packed call?
+    \param  call    target (correct) call
+    \param  copied  copied call
+    \return         whether <i>copied</i> is a plausible bust of <i>call</i>
+
+    Equivalent to is_bust(call.view(), copied.view()), but most non-busts are rejected by comparing whole words
+*/
+bool is_bust(const packed_call& call, const packed_call& copied) noexcept
+{ if (call.is_inline() and copied.is_inline())
+  { if (call.inline_length() == copied.inline_length())
+    { const int n_differences { nonzero_bytes(call.word(0) xor copied.word(0)) + nonzero_bytes(call.word(1) xor copied.word(1)) };    // the lengths match, so do not contribute
+
+      if (n_differences == 1)
+        return true;
+
+      if (n_differences != 2)                                       // identical, or too different
+        return false;
+    }
+  }
+
+  return is_bust(call.view(), copied.view());
+}
+
+/*! \brief              Test a call against many candidates
+    \param  call        target call
+    \param  candidates  contiguous candidate calls
+    \param  mask        on return, element <i>n</i> is non-zero if and only if <i>candidates[n]</i> is a bust of <i>call</i>
+
+    <i>mask</i> is supplied by the caller so that it may be reused without further allocation
+*/
+void bust_mask(const packed_call& call, span<const packed_call> candidates, vector<uint8_t>& mask) noexcept
+{ mask.resize(candidates.size());
+
+  for (size_t n { 0 }; n < candidates.size(); ++n)
+    mask[n] = is_bust(call, candidates[n]);
+}
+
+// -----------  bust_index  ----------------
+
+/*! \class  bust_index
+    \brief  An index of calls, from which all the plausible busts of any call may be found quickly
+
+    Each indexed call is filed under a set of keys: the call itself, and the call with each
+    one of its characters deleted. Two calls that are busts of one another always share
+    at least one key, so the candidates for a call are just the calls filed under its own keys;
+    is_bust() is then applied to each candidate.
+*/
+
+namespace
+{
+
+/*! \brief          Hash of a call with, optionally, one character deleted
+    \param  call    call to hash
+    \param  skip    position of the character to delete; call.size() to delete nothing
+    \return         hash of <i>call</i> without the character at position <i>skip</i>
+
+    FNV-1a; collisions merely add candidates, which are rejected by is_bust()
+*/
+uint64_t key_hash(const string_view call, const size_t skip) noexcept
+{ uint64_t rv { 0xcbf29ce484222325 };
+
+  for (size_t posn { 0 }; posn < call.size(); ++posn)
+  { if (posn != skip)
+    { rv ^= static_cast<unsigned char>(call[posn]);
+      rv *= 0x100000001b3;
+    }
+  }
+
+  return rv;
+}
+
+}
+
+/*! \brief      Add a call to the index
+    \param  id  identifier of the call to add
+
+    The index is not usable until _finish() has been called
+*/
+void bust_index::_add(const CALL_ID id)
+{ const string& call { _calls.call(id) };
+
+  for (size_t skip { 0 }; skip <= call.size(); ++skip)         // skip == call.size() is the call itself
+    _entries.emplace_back(key_hash(call, skip), id);
+}
+
+/// sort the entries so that they may be searched
+void bust_index::_finish(void)
+{ SORT(_entries);
+  _entries.erase(unique(_entries.begin(), _entries.end()), _entries.end());      // a call with a doubled character generates the same key twice
+}
+
+/*! \brief          Find all the indexed calls that are busts of a call
+    \param  call    call whose busts are to be found
+    \param  rv      vector into which the busts are placed; any prior contents are removed
+
+    <i>rv</i> is supplied by the caller so that it may be reused without further allocation
+*/
+void bust_index::busts(const string_view call, vector<CALL_ID>& rv) const
+{ rv.clear();
+
+  for (size_t skip { 0 }; skip <= call.size(); ++skip)
+  { const KEY key { key_hash(call, skip) };
+
+    for (auto it { lower_bound(_entries.cbegin(), _entries.cend(), pair { key, CALL_ID { 0 } }) }; (it != _entries.cend()) and (it->first == key); ++it)
+    { const CALL_ID candidate { it->second };
+
+      if (!contains(rv, candidate) and is_bust(call, _calls.call(candidate)))   // the same candidate may be found under several keys
+        rv += candidate;
+    }
+  }
+}
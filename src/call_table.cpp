@@ -0,0 +1,84 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   call_table.cpp
+
+    Classes for interning callsigns as dense integer identifiers
+*/
+
+#include "call_table.h"
+
+using namespace std;
+
+// -----------  call_table  ----------------
+
+/*! \class  call_table
+    \brief  Map each distinct call to a dense identifier, and back again
+
+    Identifiers are allocated sequentially from zero, in the order in which calls are first seen.
+    Not thread safe; each contest has its own table.
+*/
+
+/*! \brief          Obtain the identifier of a call, creating one if necessary
+    \param  call    call to intern
+    \return         the identifier of <i>call</i>
+*/
+CALL_ID call_table::id(string_view call)
+{ if (const auto it { _ids.find(call) }; it != _ids.end())
+    return it->second;
+
+  const CALL_ID rv { static_cast<CALL_ID>(_calls.size()) };
+
+  _calls.emplace_back(call);
+  _ids.emplace(string_view { _calls.back() }, rv);      // the key views the stored copy, not the argument
+
+  return rv;
+}
+
+/*! \brief          Obtain the identifier of a call that might not be present
+    \param  call    call to find
+    \return         the identifier of <i>call</i>, or NO_CALL if <i>call</i> has not been interned
+*/
+CALL_ID call_table::find(string_view call) const
+{ const auto it { _ids.find(call) };
+
+  return ( (it == _ids.end()) ? NO_CALL : it->second );
+}
+
+// -----------  call_id_set  ----------------
+
+/*! \class  call_id_set
+    \brief  A set of interned calls, implemented as a bitmap indexed by identifier
+
+    Iteration is over the members, in the order in which they were inserted
+*/
+
+/*! \brief      Add an identifier to the set
+    \param  id  identifier to add
+
+    Does nothing if <i>id</i> is already a member
+*/
+void call_id_set::operator+=(const CALL_ID id)
+{ if (id >= _flags.size())
+    _flags.resize(id + 1, false);
+
+  if (!_flags[id])
+  { _flags[id] = true;
+    _members.push_back(id);
+  }
+}
+
+/*! \brief      Add all the members of another set
+    \param  cis set whose members are to be added
+*/
+void call_id_set::operator+=(const call_id_set& cis)
+{ for (const CALL_ID id : cis)
+    (*this) += id;
+}
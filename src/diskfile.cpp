@@ -28,6 +28,9 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <fcntl.h>
+
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/statvfs.h>
 #include <sys/types.h>
@@ -547,3 +550,58 @@ FSID filesystem_id(const string& filename)
   
   return fs_buf.f_fsid;
 }
+
+// -----------  memory_mapped_file  ----------------
+
+/*! \class  memory_mapped_file
+    \brief  The contents of a file, mapped privately into memory
+
+    The mapping is copy-on-write: the contents may be modified in place, but
+    the modifications are never written back to the file.
+*/
+
+/*! \brief              Constructor
+    \param  filename    name of file to map
+
+    Throws diskfile_exception if the file cannot be opened, is not a regular file, or cannot be mapped
+*/
+memory_mapped_file::memory_mapped_file(const string& filename)
+{ const int fd { open(filename.c_str(), O_RDONLY) };
+
+  if (fd == -1)
+    throw diskfile_exception("Cannot open file: "s + filename);
+
+  struct stat stat_buffer;
+
+  if (fstat(fd, &stat_buffer) == -1)
+  { close(fd);
+    throw diskfile_exception("Unable to stat file: "s + filename);
+  }
+
+  if (!S_ISREG(stat_buffer.st_mode))
+  { close(fd);
+    throw diskfile_exception(filename + " is not a regular file"s);
+  }
+
+  _size = static_cast<size_t>(stat_buffer.st_size);
+
+  if (_size != 0)                           // it is not possible to map an empty file
+  { void* const p { mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) };
+
+    if (p == MAP_FAILED)
+    { close(fd);
+      throw diskfile_exception("Unable to map file: "s + filename);
+    }
+
+    _data = static_cast<char*>(p);
+    madvise(_data, _size, MADV_SEQUENTIAL);   // the file will be read from start to finish
+  }
+
+  close(fd);                                // the mapping remains valid after the descriptor is closed
+}
+
+/// destructor; unmaps the file
+memory_mapped_file::~memory_mapped_file(void)
+{ if (_data)
+    munmap(_data, _size);
+}
@@ -13,8 +13,10 @@
     Program to generate custom SCP (super check partial) files
     
     drscp -dir <directory of contest logs> [-start <start date/time>] [-hrs <duration in hours>]
-          [-v] [-l cutoff-count] [-p parallel-number]
-          [-tr call to trace] [-tl lower-limit] [-x] [-i]
+          [-v] [-l cutoff-count] [-p parallel-number] [-j number-of-threads]
+          [-tr call to trace] [-tl lower-limit] [-x] [-xpc percentages] [-o output-file] [-bin] [-i] [-cache cache-directory] [-stats stats-file] [-mem GB]
+          [-shard k/n] [-partial partial-file] [-ljf] [-index]
+    drscp -merge <partial files> [-x] [-xpc percentages] [-o output-file] [-bin] [-stats stats-file]
     
       -start        date/time of the start of the contest: YYYY-MM-DD[THH[:MM[:SS]]]
       -hrs          duration of the contest, in hours
@@ -22,11 +24,25 @@
       -l <n>        roughly, the number of times that a call must appear in the logs, even after
                     reasonable precautions have been taken to remove busts. Default 1.
       -p <n>        the number of directories to process simultaneously. Default 1.
+      -j <n>        the number of threads on which to perform the work. Default: the number of hardware threads.
       -tr <call>    provide detailed information on the processing of a particular logged call
       -tl <n>       do not automatically include entrants' calls unless they claim at least n QSOs. Default 1.
       -x            generate eXtended SCP output
-      -xpc <n>      return only the top n% of most-frequently-seen calls. Default 100.
+      -xpc <n>      return only the top n% of most-frequently-seen calls. Default 100. Several comma-separated values
+                    may be given, in which case -o is required and each output is written to its own file.
+      -o <file>     write the output to <file> instead of to the standard output. If several -xpc values are given,
+                    the value is inserted before any extension: -o xscp.txt -xpc 80,95 writes xscp-80.txt and xscp-95.txt
+      -bin          write the output in binary XSCP format, which a program can map into memory and use without parsing.
+                    Requires -o.
+      -index        include in binary XSCP output an index with which the calls that contain a string are found quickly. Requires -bin.
       -i            display erroneous QSO lines from logs on the standard error stream
+      -cache <dir>  keep the parsed logs and the calls of each contest in files in <dir>, and reuse them while the log files are unchanged
+      -stats <file> write the elapsed time, CPU time and numbers of QSOs processed and removed by each stage to <file>, in CSV format
+      -mem <GB>     limit the memory used by the directories in progress to roughly <GB> gigabytes, which need not be an integer
+      -shard <k/n>  process only contests k, k+n, k+2n... of the list of contests, numbering from 1
+      -partial <f>  write the calls to the partial file <f>, to be merged later with -merge, instead of writing the output
+      -merge <fs>   generate the output from the comma-separated partial files <fs> instead of from contest directories
+      -ljf          start the directories with the most log data first, instead of in the order in which they are listed
  
 Notes:
     
@@ -47,48 +63,126 @@ Notes:
     When using the -xpc option, a strict calculation of "top n%" might well fall in the middle of a number of calls
     with the same number of appearances. In this case, the output includes all calls that appear at least as often
     as the strict value of "top n%" might suggest. 
+
+    A cache file is reused only if the contest start and duration, and the name, size and modification time of every
+    file in the contest directory, are unchanged. The parsed logs are reused regardless of any other parameter; the calls
+    of a contest are reused only if -l and -tl are also unchanged, in which case the contest is not processed at all.
+    So when a contest is added to a list of contests, only the new contest is processed. The calls are not reused
+    with -v or -tr, which report on the processing; and the -i option always causes the logs to be parsed. In all
+    cases the cache files are rewritten as necessary.
+
+    With -mem, a directory is started only when its estimated footprint (about twice the total size of its log files) fits
+    in what remains of the budget; a directory whose footprint alone exceeds the budget is processed when no other
+    directory is in progress. The QSOs of each directory are written by band to spill files in the temporary directory
+    (TMPDIR, or /tmp) once the QSOs of every log have been examined, and the bands are then processed one at a time, each
+    from its own file; so only one band's QSOs are in memory at once, at the cost of processing the bands of a directory
+    one after another. The output is the same as without -mem.
+
+    The contests in a list may be processed on several machines: each runs drscp with -partial (and, typically, with
+    the same list and its own -shard), and the partial files are then merged with -merge, which gives the same output as
+    processing all the contests at once. The partial files must have been written with the same -l and -tl values, and
+    no contest may appear in more than one of them.
 */
 
+#include "binary_io.h"
+#include "bust.h"
+#include "call_table.h"
 #include "command_line.h"
 #include "count_values.h"
 #include "diskfile.h"
 #include "drscp.h"
+#include "log_cache.h"
 #include "macros.h"
+#include "scp_file.h"
+#include "stats.h"
 #include "string_functions.h"
+#include "thread_pool.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <numeric>
+#include <optional>
+
+#include <unistd.h>
 
 using namespace std;
 
 constinit int  CUTOFF_LIMIT     { 1 };      ///< will remove calls that appear this many (or fewer) times
 constinit int  MAX_PARALLEL     { 1 };      ///< maximum number of directories to process at once
+constinit int  N_THREADS        { 0 };      ///< number of threads in the pool; 0 => hardware concurrency
 constinit int  TL_LIMIT         { 1 };      ///< do not automatically include entrants' calls unless they claim at least this number of QSOs
-constinit int  PC_OUTPUT        { 100 };    ///< percentage of calls to return
 constinit bool DISPLAY_BAD_QSOS { false };  ///< whether to display bad QSOs from logs on cerr
+constinit bool LONGEST_FIRST    { false };  ///< whether to start the directories with the most log data first, instead of in the order listed
+
+constinit atomic<int> qso_id { 0 };         ///< global QSO counter; identifiers are allocated a whole directory at a time
+
+constinit uint64_t    MEMORY_BUDGET { 0 };  ///< memory available to the directories in progress, in bytes; 0 => no budget
+constinit atomic<int> spill_serial  { 0 };  ///< distinguishes the spill files of the directories in progress
+
+string      CACHE_DIRECTORY { };            ///< directory that holds the cached logs; empty => no cache
+string      OUTPUT_FILENAME { };            ///< file to which the output is written; empty => standard output
+vector<int> PC_OUTPUT       { 100 };        ///< percentages of calls to return, each to its own output
+string      STATS_FILENAME  { };            ///< file to which the statistics are written; empty => no statistics
+string      PARTIAL_FILENAME { };           ///< partial file to which the calls are written; empty => write the output
+
+stats_recorder STATISTICS { };              ///< the statistics of each stage; records nothing unless -stats is present
 
 constexpr int CLOCK_SKEW     { 2 };     ///< maximum permitted clock skew when comparing logs, in minutes
 constexpr int FREQ_SKEW      { 2 };     ///< maximum permitted frequency skew when comparing logs, in kHz
 constexpr int RUN_TIME_RANGE { 5 };     ///< half-width of time range for looking for a run, in minutes
 
-constinit atomic<int> processing_directories { 0 };     ///< number of directories currently being processed
+constexpr int RUN_SEGMENT_GAP { 2 * CLOCK_SKEW + 1 };   ///< greatest gap between consecutive QSOs in a run segment, in minutes; a window of +/- CLOCK_SKEW cannot fall within such a gap
+
+constexpr double FOOTPRINT_PER_LOG_BYTE { 2.0 };    ///< estimated peak memory needed to process a directory with a memory budget, per byte of its logs
+
+constexpr uint32_t MIN_CHUNK_ROWS    { 4096 };      ///< fewest rows of a band in each task when a pass over the band is split across the pool
+constexpr size_t   CHUNKS_PER_THREAD { 4 };         ///< number of tasks per thread when a pass is split, so that a thread that finishes early can take another
+
 constinit bool        tracing                { false }; ///< whether -tr option is in use
 constinit bool        verbose                { false }; ///< whether to produce verbose output
 
 string traced_call { };                                 ///< the call being traced
 
-int main(int argc, char** argv)
-{ const command_line cl(argc, argv);
+/*! \brief                  Obtain the name of an output file
+    \param  filename        the value of the -o parameter
+    \param  pcs             the percentages of calls to return
+    \param  n               index in <i>pcs</i> of the output
+    \return                 the name of the file to which output number <i>n</i> is written
 
-  if (cl.parameter_present("-v"))
-    verbose = true;
-  
-  if (!cl.value_present("-dir"s))
-  { cerr << "ERROR: no -dir flag present" << endl;
-    exit(-1);
-  }
-    
-  const string rawdirname { cl.value("-dir"s) };
+    If there is more than one output, the percentage is inserted before the extension of <i>filename</i>, if any
+*/
+string output_filename(const string& filename, const vector<int>& pcs, const size_t n)
+{ if (pcs.size() == 1)
+    return filename;
+
+  const size_t last_slash { filename.find_last_of('/') };
+  const size_t last_dot   { filename.find_last_of('.') };
+  const bool   has_ext    { (last_dot != string::npos) and (last_dot != 0) and ( (last_slash == string::npos) or (last_dot > last_slash + 1) ) };
+  const size_t posn       { has_ext ? last_dot : filename.size() };
+
+  return filename.substr(0, posn) + "-"s + to_string(pcs[n]) + filename.substr(posn);
+}
+
+/// the parameters that affect the calls from a contest
+string call_parameters(void)
+  { return "l"s + to_string(CUTOFF_LIMIT) + "-tl"s + to_string(TL_LIMIT); }
+
+// the benchmarks link the rest of this file, and are built with NO_DRSCP_MAIN defined
+#if !defined(NO_DRSCP_MAIN)
+
+/*! \brief      Obtain the contests to process
+    \param  cl  the command line
+    \return     the contests given by the -dir parameter, and by the -start and -hrs parameters for a single directory
+
+    Exits with an error if the contests are not properly specified
+*/
+vector<contest_parameters> contests_to_process(const command_line& cl)
+{ const string rawdirname { cl.value("-dir"s) };
 
   vector<string> dirnames;
 
@@ -129,6 +223,95 @@ int main(int argc, char** argv)
     params_vec += contest_parameters { dirnames[0] + " " + cl.value("-start") + " " + cl.value("-hrs") };
   }
 
+  return params_vec;
+}
+
+/*! \brief              Merge the calls in partial files
+    \param  filenames   names of the partial files
+    \return             the calls in all the files; the count of a call that appears in more than one file is the sum of its counts
+
+    Exits with an error if a file cannot be read, if the files were written with different parameters, or if a contest appears in more than one file
+*/
+collated_calls merge_partials(const vector<string>& filenames)
+{ vector<collated_calls> calls_per_file;
+  string                 parameters;
+  set<string>            directories;
+
+  for (const string& filename : filenames)
+  { try
+    { partial_calls pc { filename };
+
+      if (calls_per_file.empty())
+        parameters = pc.parameters();
+
+      if (pc.parameters() != parameters)
+      { cerr << "ERROR: partial files " << filenames[0] << " and " << filename << " were written with different -l or -tl values" << endl;
+        exit(-1);
+      }
+
+      for (const string& directory : pc.directories())
+      { if (!directories.insert(directory).second)
+        { cerr << "ERROR: contest directory " << directory << " appears in more than one partial file" << endl;
+          exit(-1);
+        }
+      }
+
+      calls_per_file += move(pc).calls();
+    }
+
+    catch (const diskfile_exception& e)
+    { cerr << "ERROR: unable to read partial file " << filename << ": " << e.what() << endl;
+      exit(-1);
+    }
+  }
+
+  if (verbose)
+    cout << "merged " << filenames.size() << " partial files, containing " << directories.size() << " directories" << endl;
+
+  return collated_calls { span<const collated_calls> { calls_per_file } };
+}
+
+int main(int argc, char** argv)
+{ const command_line cl(argc, argv);
+
+  if (cl.parameter_present("-v"))
+    verbose = true;
+  
+  const bool merging { cl.value_present("-merge"s) };      // whether to merge partial files instead of processing contest directories
+
+  if (merging and (cl.value_present("-dir"s) or cl.value_present("-partial"s)))
+  { cerr << "ERROR: -merge cannot be used with -dir or -partial" << endl;
+    exit(-1);
+  }
+
+  if (!merging and !cl.value_present("-dir"s))
+  { cerr << "ERROR: no -dir flag present" << endl;
+    exit(-1);
+  }
+
+  vector<contest_parameters> params_vec { merging ? vector<contest_parameters> { } : contests_to_process(cl) };
+
+  if (cl.value_present("-shard"s))
+  { const vector<string> fields { split_string(cl.value("-shard"s), '/') };
+    const int            k      { (fields.size() == 2) ? from_string<int>(fields[0]) : 0 };
+    const int            n      { (fields.size() == 2) ? from_string<int>(fields[1]) : 0 };
+
+    if ( (n < 1) or (k < 1) or (k > n) )
+    { cerr << "ERROR: -shard must be of the form k/n, with 1 <= k <= n" << endl;
+      exit(-1);
+    }
+
+    vector<contest_parameters> shard;
+
+    for (size_t index { static_cast<size_t>(k - 1) }; index < params_vec.size(); index += n)
+      shard += params_vec[index];
+
+    params_vec = move(shard);
+
+    if (verbose)
+      cout << "shard " << k << " of " << n << " contains " << params_vec.size() << " directories" << endl;
+  }
+
   for (const auto& cp : params_vec)
   { if (!directory_exists(cp.directory(), LINKS::INCLUDE))
     { cerr << "ERROR: raw directory " << cp.directory() << " does not exist" << endl;
@@ -148,6 +331,28 @@ int main(int argc, char** argv)
   if (verbose)
     cout << "number of directories to process in parallel = " << MAX_PARALLEL << endl;
 
+  if (cl.value_present("-j"s))
+    N_THREADS = from_string<int>(cl.value("-j"s));
+
+  LONGEST_FIRST = cl.parameter_present("-ljf"s);
+
+  if (verbose and LONGEST_FIRST)
+    cout << "directories with the most log data are started first" << endl;
+
+  if (cl.value_present("-mem"s))
+  { const double gb { from_string<double>(cl.value("-mem"s)) };
+
+    if (gb <= 0)
+    { cerr << "ERROR: -mem must be positive" << endl;
+      exit(-1);
+    }
+
+    MEMORY_BUDGET = static_cast<uint64_t>(gb * 1024 * 1024 * 1024);
+
+    if (verbose)
+      cout << "memory budget = " << gb << " GB" << endl;
+  }
+
   if (cl.value_present("-tr"s))
   { traced_call = to_upper(cl.value("-tr"));
     tracing = true;
@@ -165,321 +370,766 @@ int main(int argc, char** argv)
     cout << "output format is: " << (xscp ? "XSCP" : "SCP") << endl;
     
   if (cl.value_present("-xpc"s))
-  { PC_OUTPUT = from_string<int>(cl.value("-xpc"));
+  { PC_OUTPUT.clear();
+
+    FOR_ALL(split_string(cl.value("-xpc"s), ','), [] (const string& pc_str) { PC_OUTPUT += from_string<int>(pc_str); });
   
     if (verbose)
-      cout << "top " << PC_OUTPUT << " of values will be returned" << endl;
+      FOR_ALL(PC_OUTPUT, [] (const int pc) { cout << "top " << pc << " of values will be returned" << endl; });
+  }
+
+  if (cl.value_present("-o"s))
+    OUTPUT_FILENAME = cl.value("-o"s);
+
+  if (cl.value_present("-partial"s))
+    PARTIAL_FILENAME = cl.value("-partial"s);
+
+  if ( (PC_OUTPUT.size() > 1) and OUTPUT_FILENAME.empty() )
+  { cerr << "ERROR: -o is required when more than one -xpc value is given" << endl;
+    exit(-1);
+  }
+
+  const bool binary_output { cl.parameter_present("-bin"s) };    // whether to write binary XSCP output
+
+  if (binary_output and OUTPUT_FILENAME.empty())
+  { cerr << "ERROR: -o is required with -bin" << endl;
+    exit(-1);
+  }
+
+  const bool substring_index { cl.parameter_present("-index"s) };     // whether to include a substring index in binary XSCP output
+
+  if (substring_index and !binary_output)
+  { cerr << "ERROR: -bin is required with -index" << endl;
+    exit(-1);
   }
   
   DISPLAY_BAD_QSOS = cl.parameter_present("-i"s);       // whether to print bad QSOs from logs
-  
-  CALL_MAP xscp_calls(compare_calls);                   // the calls to be printed
- 
-  list<future<CALL_MAP>> futures;
- 
-// queue all the directories for processing, as resources become available 
-  for (const contest_parameters& cp : params_vec)
-  { if (verbose)
-      cout << "queuing directory " << cp.directory() << " for processing when a thread becomes free" << endl;
-  
-    while (processing_directories == MAX_PARALLEL)
-    { for (auto it { futures.begin() }; it != futures.end(); ++it)
-      { if (it->wait_for(0s) == future_status::ready)               // if a thread has completed
-        { xscp_calls += move(it->get());
- 
-          futures.erase(it);
-          processing_directories--;
- 
-          break;
-        }
-      }
-        
-      this_thread::sleep_for(1s);
-    }
-    
-    futures.emplace(futures.end(), async(std::launch::async, process_directory, cp));
-    
-    if (verbose)
-      cout << "started processing directory " << cp.directory() << endl;
-    
-    processing_directories++;
+
+  if (cl.value_present("-stats"s))
+  { STATS_FILENAME = cl.value("-stats"s);
+    STATISTICS.enabled(true);
   }
-  
-  while (!futures.empty())
-  { for (auto it { futures.begin() }; it != futures.end(); ++it)
-    { if (it->wait_for(0s) == future_status::ready)
-      { xscp_calls += move(it->get());
-        
-        futures.erase(it);
-        processing_directories--;
 
-        break;
-      }
+  if (cl.value_present("-cache"s))
+  { CACHE_DIRECTORY = cl.value("-cache"s);
+
+    try
+    { directory_create_if_necessary(CACHE_DIRECTORY);
+    }
+
+    catch (const exception& e)
+    { cerr << "ERROR: unable to create cache directory " << CACHE_DIRECTORY << ": " << e.what() << endl;
+      exit(-1);
     }
-      
-    if (!futures.empty())
-      this_thread::sleep_for(1s);
   }
+  
+  thread_pool pool { (N_THREADS > 0) ? static_cast<unsigned int>(N_THREADS) : thread::hardware_concurrency() };   // all the work is performed on this pool
 
-// possibly prune the list for output
-  if (PC_OUTPUT != 100)
-  { vector<int> values;
-    values.reserve(xscp_calls.size());
-    
-    FOR_ALL(xscp_calls, [&values] (const auto& pr) { values += pr.second; });
-    
-    erase_if(xscp_calls, [val_limit = value_line(values, PC_OUTPUT)] (const auto& pr) { return (pr.second < val_limit); });
+  if (verbose)
+    cout << "number of threads = " << pool.size() << endl;
+
+// the order in which to start the directories: as listed or, with -ljf, those with the most log data first, so that a large
+// directory listed last does not determine the total elapsed time; the calls are merged in the order listed regardless
+  vector<size_t> start_order(params_vec.size());
+
+  iota(start_order.begin(), start_order.end(), size_t { 0 });
+
+  if (LONGEST_FIRST)
+  { vector<pair<uint64_t /* bytes */, size_t /* logs */>> sizes;
+
+    FOR_ALL(params_vec, [&sizes] (const contest_parameters& cp) { sizes += log_sizes(cp); });
+    stable_sort(start_order.begin(), start_order.end(), [&sizes] (const size_t index1, const size_t index2) { return (sizes[index1] > sizes[index2]); });
   }
 
-// we are finished; output the list of [X]SCP calls, one per line
-  if (xscp)
-    FOR_ALL(xscp_calls, [] (const auto& pr) { cout << pr.first << " " << pr.second << endl; });
-  else
-    FOR_ALL(xscp_calls, [] (const auto& pr) { cout << pr.first << endl; });
-  
-  return 1;
-}
+// process the directories in that order; there are at most MAX_PARALLEL in progress at once and, if there is a memory budget,
+// a directory is started only when its estimated footprint fits in what remains of the budget, or when no other directory is in progress
+  vector<collated_calls>                                         directory_calls(params_vec.size());   // the calls from each directory
+  vector<pair<future<void>, uint64_t /* estimated footprint */>> in_progress;                          // the directories in progress
+  uint64_t                                                       committed_memory { 0 };               // the sum of the footprints of the directories in progress
+  stage_timer                                                    queue_timer { STATISTICS, true };     // records how long each directory waits to be started
 
-/*  \brief          Is a copied call a bust of another call?
-    \param  call    target (correct) call
-    \param  copied  copied call
-    \return         whether <i>copied</i> is a plausiblg bust of <i>call</i>
-    
-    This is shamelessly copied from contest_statistics, with no substantive changes
-*/
-bool is_bust(const string& call, const string& copied) noexcept
-{ if (call == copied)
-    return false;                // not a bust if it's copied OK
+  auto is_finished = [] (const pair<future<void>, uint64_t>& pr) { return (pr.first.wait_for(chrono::seconds(0)) == future_status::ready); };
 
-  if ( abs(ssize(call) - ssize(copied)) >= 2 )
-    return false;                // not a bust if the lengths differ by 2 or more
+  if (verbose)
+    cout << "queued " << params_vec.size() << " directories for processing, at most " << MAX_PARALLEL << " at once" << endl;
 
-  if ( abs(ssize(call) - ssize(copied)) == 1 )  // lengths differ by unity
-  { const string& longer  { (call.length() > copied.length() ? call : copied) };
-    const string& shorter { (call.length() > copied.length() ? copied : call) };
+  for (const size_t index : start_order)
+  { const uint64_t footprint { MEMORY_BUDGET ? estimated_footprint(params_vec[index]) : 0 };
 
-    if (contains(longer, shorter))
-      return true;
+    auto admissible = [&in_progress, &committed_memory, footprint] (void)
+      { return in_progress.empty() or ( (ssize(in_progress) < MAX_PARALLEL) and (!MEMORY_BUDGET or (committed_memory + footprint <= MEMORY_BUDGET)) ); };
 
-// is the bust in the form of an additional character, or a missing character, somewhere in the call?
-    for (size_t posn { 1 }; posn < longer.length() - 1; ++posn)
-    { const string tmp { longer.substr(0, posn) + longer.substr(posn + 1) };
+    while (!admissible())
+    { pool.wait_until( [&in_progress, &is_finished] (void) { return ANY_OF(in_progress, is_finished); } );
 
-      if (tmp == shorter)
-        return true;
+      for (auto it { in_progress.begin() }; it != in_progress.end(); )
+      { if (is_finished(*it))
+        { it->first.get();
+          committed_memory -= it->second;
+          it = in_progress.erase(it);
+        }
+        else
+          ++it;
+      }
     }
 
-    return false;
-  }
+    if (verbose)
+      cout << "started processing directory " << params_vec[index].directory() << endl;
 
-// call and copied are the same length; do they differ by exactly one character?
-  int differences { 0 };
+    queue_timer.record(params_vec[index].directory(), ""s, "queued"s, 0);
 
-  for (size_t posn { 0 }; posn < call.length(); ++posn)
-  { if (call[posn] != copied[posn])
-      differences++;
+    committed_memory += footprint;
+    in_progress.emplace_back(pool.submit( [&directory_calls, &params_vec, &pool, index] (void) { directory_calls[index] = process_directory(params_vec[index], pool); } ), footprint);
   }
 
-  if (differences == 1)
-    return true;
+  FOR_ALL(in_progress, [&pool] (pair<future<void>, uint64_t>& pr) { pool.wait(pr.first); });
 
-// is there a character inversion?
-  for (size_t posn { 0 }; posn < call.length() - 1; ++posn)
-  { string call_tmp { call };
+// merge the calls from all the directories, or from all the partial files, in callsign order
+  collated_calls xscp_calls { merging ? merge_partials(split_string(cl.value("-merge"s), ','))
+                                      : collated_calls { span<const collated_calls> { directory_calls } } };   // the calls to be printed
 
-    swap(call_tmp[posn], call_tmp[posn + 1]);
+  directory_calls.clear();
 
-    if (call_tmp == copied)
-      return true;
+  if (!PARTIAL_FILENAME.empty())                        // write the calls for a later merge, instead of the output
+  { vector<string> directories;
+
+    FOR_ALL(params_vec, [&directories] (const contest_parameters& cp) { directories += cp.directory(); });
+
+    const string contents { partial_calls { call_parameters(), directories, move(xscp_calls) }.contents() };
+
+    ofstream ofs { PARTIAL_FILENAME, ios::binary | ios::trunc };
+
+    if (ofs.write(contents.data(), contents.size()); ofs.close(), !ofs)
+    { cerr << "ERROR: unable to write partial file " << PARTIAL_FILENAME << endl;
+      exit(-1);
+    }
   }
+  else
+  {
+// the least count of a call in each output; every call is output if the percentage is 100
+    vector<int> values;
+    values.reserve(xscp_calls.size());
 
-  return false;
-}
+    FOR_ALL(xscp_calls.entries(), [&values] (const auto& pr) { values += pr.second; });
 
-/*  \brief                  Split a log into per-band minilogs
-    \param  qsos_per_call   all the QSOs for each call
-    \return                 <i>qsos_per_call</i> divided into per-band logs
-*/
-auto build_minilog(const unordered_map<string /* tcall */, vector<small_qso>>& qsos_per_call) -> unordered_map<HF_BAND, base_type<decltype(qsos_per_call)>> 
-{ unordered_map<HF_BAND, base_type<decltype(qsos_per_call)>> rv;
-  
-  for (const auto& [ tcall, qsos ] : qsos_per_call)
-  { for (const small_qso& qso : qsos)
-    { const HF_BAND band_qsos { qso.band() };
-      const string& tcall     { qso.tcall() };
-      
-      rv[band_qsos][tcall] += qso;
+    const vector<int> val_limits { value_lines(values, PC_OUTPUT) };
+
+// we are finished; output the list of [X]SCP calls to each output, each in a single write
+    for (size_t n { 0 }; n < PC_OUTPUT.size(); ++n)
+    { const string contents { binary_output ? binary_xscp(xscp_calls, val_limits[n], substring_index) : scp_text(xscp_calls, val_limits[n], xscp) };
+
+      if (OUTPUT_FILENAME.empty())
+        cout.write(contents.data(), contents.size()).flush();
+      else
+      { const string filename { output_filename(OUTPUT_FILENAME, PC_OUTPUT, n) };
+
+        ofstream ofs { filename, ios::binary | ios::trunc };
+
+        if (ofs.write(contents.data(), contents.size()); ofs.close(), !ofs)
+        { cerr << "ERROR: unable to write output file " << filename << endl;
+          exit(-1);
+        }
+      }
     }
   }
-  
-  return rv;
-}
 
-/*  \brief                  Convert a minilog into a time-ordered vector
-    \param  qsos_per_call   all the QSOs for each call
-    \return                 <i>qsos_per_call</i> organised as a single chronological vector
-*/
-vector<small_qso> build_vec(const unordered_map<string /* tcall */, vector<small_qso>>& qsos_per_call)
-{ vector<small_qso> rv;            // all QSOs on this band
-  
-// calculate the putative size
-  size_t rv_size { 0 };
-  
-  for (const auto& [ tcall, qsos_this_call ] : qsos_per_call)       // structured binding in lambda is not permitted
-    rv_size += qsos_this_call.size();
-    
-  rv.reserve(rv_size);
-    
-  for (const auto& [ tcall, qsos_this_call ] : qsos_per_call)
-    FOR_ALL(qsos_this_call, [&rv] (const small_qso& qso) { rv += qso; } );
+  if (STATISTICS.enabled())
+  { ofstream ofs { STATS_FILENAME, ios::trunc };
 
-// put in chronological order
-  SORT(rv);
+    if (ofs << STATISTICS.csv(); ofs.close(), !ofs)
+      cerr << "WARNING: unable to write statistics file " << STATS_FILENAME << endl;
+  }
   
-  return rv;
+  return 1;
 }
 
-/*  \brief                  Return all the tcalls in all minilogs
-    \param  qsos_per_call   all the QSOs for each call
-    \return                 all the tcalls that appear in all the QSOs
+#endif    // !NO_DRSCP_MAIN
+
+// -----------  collated_calls  ----------------
+
+/*! \class  collated_calls
+    \brief  Calls and their counts, held as a flat vector in callsign sort order
+
+    Each call is held as its collation key, so that calls are ordered and merged by ordinary string comparison
 */
-unordered_set<string> tcalls(const unordered_map<string /* tcall */, vector<small_qso>>& qsos_per_call)
-{ unordered_set<string> rv { };
 
-  for (const auto& [ tcall, qso_vec ] : qsos_per_call)
-    rv += tcall;
+/*! \brief                      Constructor
+    \param  calls_and_counts    distinct calls and their counts, in any order
+*/
+collated_calls::collated_calls(const vector<pair<string, int>>& calls_and_counts)
+{ _entries.reserve(calls_and_counts.size());
 
-  return rv;
+  FOR_ALL(calls_and_counts, [this] (const auto& pr) { _entries.emplace_back(call_collation_key(pr.first), pr.second); });
+
+  SORT(_entries);                           // the calls are distinct, so this orders by key alone
 }
 
-/*  \brief          Build a map that converts from time to the iterator for the first element for that minute in a chronologically-sorted QSO vector
-    \param  vec     chronologically-sorted QSO vector
-    \return         map that converts from time (for each minute) to the iterator for the first element of <i>vec</i>for that minute
+/*! \brief          Constructor from the merger of several sets of calls
+    \param  ccs     the sets to be merged
+
+    The count of a call that appears in more than one set is the sum of its counts.
+    The sets are merged in a single k-way pass, taking the least remaining key from a heap of the sets.
 */
-vector<vector<small_qso>::const_iterator> time_map(const vector<small_qso>& vec, const int max_rel_mins)
-{ vector<vector<small_qso>::const_iterator> rv;
+collated_calls::collated_calls(span<const collated_calls> ccs)
+{ using ENTRY_IT = vector<pair<string, int>>::const_iterator;
 
-  if (vec.empty())                  // should never be true
-    return rv;
-  
-  const int time_map_size { static_cast<int>(max_rel_mins) + 1 };   // note the +1
-  
-  rv.reserve(time_map_size);
+  vector<pair<ENTRY_IT, ENTRY_IT>> heap;        // the next and end entries of each set that has entries remaining
+  size_t                           max_size { 0 };
 
-  vector<small_qso>::const_iterator last_start { vec.cbegin() };
+  for (const collated_calls& cc : ccs)
+  { if (cc.size())
+      heap.emplace_back(cc._entries.cbegin(), cc._entries.cend());
 
-  for (long int minutes { 0 }; minutes <= max_rel_mins; ++minutes)
-  { rv += lower_bound(last_start, vec.end(), minutes, [] (const auto& element, const auto& target) { return (element.rel_mins() < target); });
-    last_start = rv[rv.size() - 1];
+    max_size += cc.size();
   }
-    
-  rv += vec.end();
 
-  return rv;
+  const auto later = [] (const pair<ENTRY_IT, ENTRY_IT>& a, const pair<ENTRY_IT, ENTRY_IT>& b) { return (a.first->first > b.first->first); };
+
+  _entries.reserve(max_size);
+  make_heap(heap.begin(), heap.end(), later);
+
+  while (!heap.empty())
+  { pop_heap(heap.begin(), heap.end(), later);
+
+    auto& [ next, end ] { heap.back() };
+
+    if (!_entries.empty() and (_entries.back().first == next->first))
+      _entries.back().second += next->second;
+    else
+      _entries.push_back(*next);
+
+    if (++next == end)
+      heap.pop_back();
+    else
+      push_heap(heap.begin(), heap.end(), later);
+  }
 }
 
-/*! \brief                              Generate the SCP calls from containers of pruned and all QSOs
-    \param  pruned_qsos_this_band       the pruned QSOs (for a band)
-    \param  all_qsos_this_band          all the QSOs (for the band)
-    \param  calls_with_no_freq_info     the calls that have no reliable frequency info in the log
-    \param  calls_with_poor_freq_info
-    \param  max_rel_mins                the number of minutes in the contest - 1
-    \return                             the SCP calls after adding those from the containers
+// -----------  band_log  ----------------
+
+/*! \class  band_log
+    \brief  Columnar store of all the QSOs on a single band
+
+    Each QSO is a row, and rows are in chronological order. The rows for each minute,
+    and the rows for each tcall (in chronological order), are available as ranges.
 */
-unordered_set<string> process_band(const unordered_map<string /* tcall */, vector<small_qso>>& pruned_qsos_this_band,
-                                   const unordered_map<string /* tcall */, vector<small_qso>>& all_qsos_this_band,
-                                   const unordered_set<string>& calls_with_no_freq_info,
-                                   const unordered_set<string>& calls_with_poor_freq_info,
-                                   const int max_rel_mins)
-{ 
-// put all the qsos on this band, and all the pruned qsos, into vectors
-  vector<small_qso> pruned_vec { build_vec(pruned_qsos_this_band) };
-
-  const vector<small_qso>     all_vec    { build_vec(all_qsos_this_band) };
-  const string                band_str   { HF_BAND_STR.at(static_cast<int>(all_vec[0].band())) + "m" }; // string to be used to identify the band in output
-  const unordered_set<string> all_tcalls { tcalls(all_qsos_this_band) };                                // all the tcalls on this band
 
-/*  \brief          Are two frequencies approximately the same?
-    \param  qso1    QSO #1
-    \param  qso2    QSO #2
-    \param  def     whether calls with no detailed frequency info suggests a frequency match
-    \return         whether <i>qso1</i> and <qso2> are reoughly on the same frequency (to within FREQ_SKEW kHz)
+/*! \brief                  Constructor
+    \param  b               band
+    \param  qsos            all the QSOs on band <i>b</i>, in any order
+    \param  max_rel_mins                the number of minutes in the contest - 1
+    \param  calls                       table in which the calls are interned
+    \param  calls_with_no_freq_info     entrants whose logged frequency information is useless
+    \param  calls_with_poor_freq_info   entrants whose logged frequency information is untrustworthy
 */
-  auto frequency_match = [&calls_with_no_freq_info, &calls_with_poor_freq_info] (const small_qso& qso1, const small_qso& qso2, const bool def) 
-    { if (def)
-        return ( (calls_with_no_freq_info.contains(qso1.tcall()) or calls_with_no_freq_info.contains(qso2.tcall())) or 
-                 (calls_with_poor_freq_info.contains(qso1.tcall()) or calls_with_poor_freq_info.contains(qso2.tcall())) or 
-                 (abs(qso1.qrg() - qso2.qrg()) <= FREQ_SKEW) );
-      else
-// this is a fudge -- some stations have freq info for only SOME QSOs, (these stns are in calls_with_poor_freq_info).
-// This might mischaracterise QSOs close to the band edge, but I think that that's the lesser of the two evils      
-        return ( (!calls_with_no_freq_info.contains(qso1.tcall()) and !calls_with_no_freq_info.contains(qso2.tcall())) and 
- //                (!calls_with_poor_freq_info.contains(qso1.tcall()) and !calls_with_poor_freq_info.contains(qso2.tcall())) and
-                 (abs(qso1.qrg() - qso2.qrg()) <= FREQ_SKEW) ); 
-    };
+band_log::band_log(const HF_BAND b, const vector<const small_qso*>& qsos, const int max_rel_mins, const call_table& calls,
+                   const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info) :
+  _band(b)
+{ const uint32_t n_rows { static_cast<uint32_t>(qsos.size()) };
 
-// look for specific QSO busts, where the frequency and time in two logs match, and an rcall is a bust of a tcall
-  unordered_set<int> ids_to_remove;
-  
-// go through the pruned log, minute by minute; start by building maps from times to vector elements
-  const vector<vector<small_qso>::const_iterator> all_time_map    { time_map(all_vec, max_rel_mins) };
-  const vector<vector<small_qso>::const_iterator> pruned_time_map { time_map(pruned_vec, max_rel_mins) };
-  
-  for (int target_rel_mins { 0 }; target_rel_mins <= max_rel_mins; ++target_rel_mins)
-  { const time_t lower_target_minutes { max(target_rel_mins - CLOCK_SKEW, 0) };
-    const time_t upper_target_minutes { min(target_rel_mins + CLOCK_SKEW, max_rel_mins) };
+// counting sort by minute; the times are already known to lie within the contest
+  _minute_start.assign(max_rel_mins + 2, 0);
 
-// create vector of (pruned) rcalls that are targets for this exact minute
-    vector<small_qso> pruned_rcall_targets;
+  FOR_ALL(qsos, [this] (const small_qso* qso_p) { _minute_start[qso_p->rel_mins() + 1]++; });
 
-    copy(pruned_time_map.at(target_rel_mins), pruned_time_map.at(target_rel_mins + 1), back_inserter(pruned_rcall_targets));     // these are all the pruned rcalls during the target minute
-    
-// look for matches
-    for (const small_qso& rqso : pruned_rcall_targets)
-    { const auto it { find_if(all_time_map.at(lower_target_minutes), all_time_map.at(upper_target_minutes + 1),
-                               [&frequency_match, &rqso] (const small_qso& tqso) 
-                                 { return (frequency_match(tqso, rqso, true) and
-                                            ((is_bust(tqso.tcall(), rqso.rcall()) and (tqso.rcall() == rqso.tcall())) or 
-                                              (is_bust(rqso.tcall(), tqso.rcall()) and (is_bust(tqso.tcall(), rqso.rcall()))))); })
-                    };
-                    
-      if (it != all_time_map.at(upper_target_minutes + 1))  // end() for the all_vec vector
-      { ids_to_remove += rqso.id();
-        
-        if (verbose)
-          cout << band_str << ": marked for removal: " << rqso << "; tcall match = " << *it << endl;
-          
-        if (tracing and (rqso.rcall() == traced_call))
-          cout << band_str << ": traced call " << traced_call << " marked for removal: " << rqso << "; tcall match = " << *it << endl;
-      }
-    }  
+  partial_sum(_minute_start.begin(), _minute_start.end(), _minute_start.begin());
+
+  vector<const small_qso*> ordered(n_rows);
+  vector<uint32_t>         next_row { _minute_start };        // the next row to be filled for each minute
+
+  FOR_ALL(qsos, [&next_row, &ordered] (const small_qso* qso_p) { ordered[next_row[qso_p->rel_mins()]++] = qso_p; });
+
+// within each minute, order by frequency, so that a range of frequencies in a minute is a range of rows
+  for (int m { 0 }; m <= max_rel_mins; ++m)
+    sort(ordered.begin() + _minute_start[m], ordered.begin() + _minute_start[m + 1], [] (const small_qso* p1, const small_qso* p2) { return (p1->qrg() < p2->qrg()); });
+
+  _time.resize(n_rows);
+  _rel_mins.resize(n_rows);
+  _qrg.resize(n_rows);
+  _tcall.resize(n_rows);
+  _rcall.resize(n_rows);
+  _id.resize(n_rows);
+  _packed_tcall.resize(n_rows);
+
+  for (uint32_t row { 0 }; row < n_rows; ++row)
+  { const small_qso* qso_p { ordered[row] };
+
+    _time[row]     = qso_p->time();
+    _rel_mins[row] = qso_p->rel_mins();
+    _qrg[row]      = qso_p->qrg();
+    _tcall[row]    = qso_p->tcall();
+    _rcall[row]    = qso_p->rcall();
+    _id[row]       = qso_p->id();
+
+    _packed_tcall[row] = packed_call { calls.call(qso_p->tcall()) };    // the call table is stable, so long calls may refer to it
   }
-  
-  if (verbose)
-    cout << band_str << ": number of QSO IDs to remove: " << ids_to_remove.size() << endl;
-  
-// remove the marked QSOs
-  erase_if(pruned_vec, [&ids_to_remove] (const small_qso& qso) { return ids_to_remove.contains(qso.id()); });
-  
-  if (verbose)
-    cout << band_str << ": current number of QSOs in pruned_vec = " << pruned_vec.size() << endl;
 
-  if (tracing)
-  { int counter { 0 };
-  
-    cout << band_str << ": Remaining traced QSOs after initial removal: " << endl;
-  
-    FOR_ALL(pruned_vec, [band_str, &counter] (const small_qso& qso) { if (qso.rcall() == traced_call)
-                                                                     { cout << "  " << band_str << ": " << qso << endl;
-                                                                       counter++;
-                                                                     }
-                                               });
-    cout << band_str << ": Pruned number of QSOs containing traced call = " << counter << endl;
+// the rows, for each minute, whose tcall has untrustworthy frequency information 
+  _unreliable_start.assign(max_rel_mins + 2, 0);
+
+  for (uint32_t row { 0 }; row < n_rows; ++row)
+  { if (!call_has_good_freq_info(_tcall[row], calls_with_no_freq_info, calls_with_poor_freq_info))
+    { _unreliable_rows += row;
+      _unreliable_start[_rel_mins[row] + 1]++;
+    }
   }
 
-  ids_to_remove.clear();        // reset, so can be repopulated
+  partial_sum(_unreliable_start.begin(), _unreliable_start.end(), _unreliable_start.begin());
 
-/* handle the following situation:
+// group the rows by tcall; because the rows are visited in order, each group is chronological
+  _tcall_start.assign(calls.size() + 1, 0);
+
+  FOR_ALL(_tcall, [this] (const CALL_ID tcall) { _tcall_start[tcall + 1]++; });
+
+  partial_sum(_tcall_start.begin(), _tcall_start.end(), _tcall_start.begin());
+
+  _tcall_rows.resize(n_rows);
+
+  vector<uint32_t> next_posn { _tcall_start };        // the next position to be filled for each tcall
+
+  for (uint32_t row { 0 }; row < n_rows; ++row)
+  { _tcall_rows[next_posn[_tcall[row]]++] = row;
+    _tcalls += _tcall[row];
+  }
+}
+
+/*! \brief              The rows in a minute within a range of frequencies
+    \param  m           relative minute
+    \param  low_qrg     lowest frequency, in kHz
+    \param  high_qrg    highest frequency, in kHz
+    \return             the first row and one past the last row in minute <i>m</i> whose frequency lies in the range [<i>low_qrg</i>, <i>high_qrg</i>]
+*/
+pair<uint32_t, uint32_t> band_log::qrg_rows(const int m, const int low_qrg, const int high_qrg) const
+{ const auto first { _qrg.cbegin() + _minute_start.at(m) };
+  const auto last  { _qrg.cbegin() + _minute_start.at(m + 1) };
+  const auto lb    { lower_bound(first, last, low_qrg) };
+  const auto ub    { upper_bound(lb, last, high_qrg) };
+
+  return { static_cast<uint32_t>(lb - _qrg.cbegin()), static_cast<uint32_t>(ub - _qrg.cbegin()) };
+}
+
+/*! \brief          Convert a row to a printable string
+    \param  row     target row
+    \param  calls   table in which the calls are interned
+    \return         human-readable description of the QSO in row <i>row</i>
+*/
+string band_log::to_string(const uint32_t row, const call_table& calls) const
+{ ostringstream ost;
+
+  ost << "Id: " << _id[row] << ", time = " << _time[row] << ", band = " << HF_BAND_STR.at(static_cast<int>(_band)) << "m"
+      << ", qrg = " << _qrg[row] << ", tcall = " << calls.call(_tcall[row]) << ", rcall = " << calls.call(_rcall[row]);
+
+  return ost.str();
+}
+
+// -----------  run_segments  ----------------
+
+/*! \class  run_segments
+    \brief  For each entrant on a band, the periods during which it was on a particular frequency
+
+    For an entrant whose frequency information is good, a segment is a sequence of consecutive QSOs in its own log on the
+    same frequency, with no gap between them of more than RUN_SEGMENT_GAP minutes; so a window of +/- CLOCK_SKEW minutes
+    that overlaps a segment contains at least one of its QSOs. For an entrant whose frequency information cannot be trusted,
+    each QSO in which another station logged the entrant is a segment, which also records that station.
+
+    The segments of each entrant are in chronological order, and do not overlap.
+*/
+
+/*! \brief                              Constructor
+    \param  bl                          all the QSOs on a band
+    \param  max_rel_mins                the number of minutes in the contest - 1
+    \param  n_calls                     the number of calls in the call table
+    \param  calls_with_no_freq_info     the calls that have no reliable frequency info in the log
+    \param  calls_with_poor_freq_info   entrants whose logged frequency information is untrustworthy
+    \param  entrants                    the entrants whose segments are needed
+
+    Only the segments of <i>entrants</i> are built; the other calls have none
+*/
+run_segments::run_segments(const band_log& bl, const int max_rel_mins, const size_t n_calls, const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info,
+                           const call_id_set& entrants) :
+  _maximum_minutes(max_rel_mins)
+{ call_id_set untrustworthy_entrants;                 // the members of entrants whose frequency information cannot be trusted
+
+  for (const CALL_ID call : entrants)
+    if (bl.tcalls().contains(call) and !call_has_good_freq_info(call, calls_with_no_freq_info, calls_with_poor_freq_info))
+      untrustworthy_entrants += call;
+
+// the rows in which another station logged an untrustworthy entrant, grouped by entrant; because the rows are visited in order, each group is chronological
+  vector<uint32_t> logged_start(n_calls + 1, 0);
+  vector<uint32_t> logged_rows;
+
+  if (!untrustworthy_entrants.empty())
+  { vector<uint32_t> rows;
+
+    for (uint32_t row { 0 }; row < bl.size(); ++row)
+      if (untrustworthy_entrants.contains(bl.rcall(row)))
+        rows += row;
+
+    FOR_ALL(rows, [&bl, &logged_start] (const uint32_t row) { logged_start[bl.rcall(row) + 1]++; });
+    partial_sum(logged_start.begin(), logged_start.end(), logged_start.begin());
+    logged_rows.resize(rows.size());
+
+    vector<uint32_t> next_posn { logged_start };          // the next position to be filled for each entrant
+
+    FOR_ALL(rows, [&bl, &logged_rows, &next_posn] (const uint32_t row) { logged_rows[next_posn[bl.rcall(row)]++] = row; });
+  }
+
+  auto add_segment = [this] (const int rel_mins, const int qrg, const CALL_ID logger)
+    { _first_mins += rel_mins;
+      _last_mins += rel_mins;
+      _qrg += qrg;
+      _logger += logger;
+    };
+
+// there are at most as many segments as rows
+  size_t max_segments { logged_rows.size() };
+
+  FOR_ALL(entrants, [&bl, &max_segments] (const CALL_ID call) { max_segments += bl.tcall_rows(call).size(); });
+
+  _first_mins.reserve(max_segments);
+  _last_mins.reserve(max_segments);
+  _qrg.reserve(max_segments);
+  _logger.reserve(max_segments);
+  _call_start.reserve(n_calls + 1);
+
+  for (CALL_ID call { 0 }; call < n_calls; ++call)
+  { _call_start += static_cast<uint32_t>(size());
+
+    if (!entrants.contains(call) or !bl.tcalls().contains(call))
+      continue;
+
+    if (untrustworthy_entrants.contains(call))
+    { for (uint32_t n { logged_start[call] }; n < logged_start[call + 1]; ++n)
+        add_segment(bl.rel_mins(logged_rows[n]), bl.qrg(logged_rows[n]), bl.tcall(logged_rows[n]));
+    }
+    else
+    { for (const uint32_t row : bl.tcall_rows(call))
+      { const bool extends_segment { (size() > _call_start.back()) and (_qrg.back() == bl.qrg(row)) and (bl.rel_mins(row) - _last_mins.back() <= RUN_SEGMENT_GAP) };
+
+        if (extends_segment)
+          _last_mins.back() = bl.rel_mins(row);
+        else
+          add_segment(bl.rel_mins(row), bl.qrg(row), NO_CALL);
+      }
+    }
+  }
+
+  _call_start += static_cast<uint32_t>(size());
+}
+
+/*! \brief                  Determine whether a station is running at a particular time and on a particular frequency
+    \param  call            call of the target station
+    \param  rel_mins        target relative minutes
+    \param  qrg             target frequency, in kHz
+    \param  ignore_call     ignore QSOs logged by this call (typically the station that reported working <i>call</i> at this time and frequency)
+    \return                 whether <i>call</i> is an entrant that appears to have been running within CLOCK_SKEW minutes of <i>rel_mins</i>, within FREQ_SKEW kHz of <i>qrg</i>
+
+    <i>ignore_call</i> applies only to entrants whose frequency information cannot be trusted, as only they are found in the logs of other stations
+*/
+bool run_segments::is_running(const CALL_ID call, const int rel_mins, const int qrg, const CALL_ID ignore_call) const
+{ if (call + 1 >= _call_start.size())
+    return false;
+
+  const int  lower_target_minutes { max(rel_mins - CLOCK_SKEW, 0) };
+  const int  upper_target_minutes { min(rel_mins + CLOCK_SKEW, _maximum_minutes) };
+  const auto first                { _last_mins.cbegin() + _call_start[call] };
+  const auto last                 { _last_mins.cbegin() + _call_start[call + 1] };
+
+// the segments overlap the window from the first that ends within or after it, to the last that starts within or before it
+  for (auto n { static_cast<uint32_t>(lower_bound(first, last, lower_target_minutes) - _last_mins.cbegin()) };
+       (n < _call_start[call + 1]) and (_first_mins[n] <= upper_target_minutes); ++n)
+    if ( (abs(qrg - _qrg[n]) <= FREQ_SKEW) and (_logger[n] != ignore_call) )
+      return true;
+
+  return false;
+}
+
+/*  \brief                  Split a log into per-band columnar logs
+    \param  qsos_per_call   all the QSOs for each call
+    \param  max_rel_mins    the number of minutes in the contest - 1
+    \param  calls                       table in which the calls are interned
+    \param  calls_with_no_freq_info     entrants whose logged frequency information is useless
+    \param  calls_with_poor_freq_info   entrants whose logged frequency information is untrustworthy
+    \return                             <i>qsos_per_call</i> divided into per-band logs
+*/
+auto build_minilog(const unordered_map<CALL_ID /* tcall */, vector<small_qso>>& qsos_per_call, const int max_rel_mins, const call_table& calls,
+                   const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info) -> unordered_map<HF_BAND, band_log>
+{ unordered_map<HF_BAND, vector<const small_qso*>> qsos_per_band;
+  
+  for (const auto& [ tcall, qsos ] : qsos_per_call)
+    for (const small_qso& qso : qsos)
+      qsos_per_band[qso.band()] += &qso;
+
+  unordered_map<HF_BAND, band_log> rv;
+
+  for (const auto& [ band, qsos ] : qsos_per_band)
+    rv.emplace(band, band_log { band, qsos, max_rel_mins, calls, calls_with_no_freq_info, calls_with_poor_freq_info });
+  
+  return rv;
+}
+
+/*  \brief                  Convert a minilog into a time-ordered vector
+    \param  qsos_per_call   all the QSOs for each call
+    \return                 <i>qsos_per_call</i> organised as a single chronological vector
+*/
+vector<small_qso> build_vec(const unordered_map<CALL_ID /* tcall */, vector<small_qso>>& qsos_per_call)
+{ vector<small_qso> rv;            // all QSOs on this band
+  
+// calculate the putative size
+  size_t rv_size { 0 };
+  
+  for (const auto& [ tcall, qsos_this_call ] : qsos_per_call)       // structured binding in lambda is not permitted
+    rv_size += qsos_this_call.size();
+    
+  rv.reserve(rv_size);
+    
+  for (const auto& [ tcall, qsos_this_call ] : qsos_per_call)
+    FOR_ALL(qsos_this_call, [&rv] (const small_qso& qso) { rv += qso; } );
+
+// put in chronological order
+  SORT(rv);
+  
+  return rv;
+}
+
+/*! \brief          Apply a function to consecutive chunks of the rows of a band, splitting the chunks across a pool
+    \param  n_rows  number of rows in the band
+    \param  pool    pool on which to run the chunks
+    \param  timer   timer of the stage, to which the CPU time of the chunks is charged
+    \param  fn      function that takes the first row of a chunk and the row after the last, and returns a vector of results
+    \return         the results of all the chunks, in order of row
+
+    <i>fn</i> must not change anything that another chunk reads. A band that is too small to be worth splitting,
+    or a pool with only one thread, is processed as a single chunk on the calling thread
+*/
+template <typename F>
+auto for_row_chunks(const uint32_t n_rows, thread_pool& pool, stage_timer& timer, F&& fn) -> invoke_result_t<F, uint32_t, uint32_t>
+{ using R = invoke_result_t<F, uint32_t, uint32_t>;
+
+  const size_t n_chunks { min(pool.size() * CHUNKS_PER_THREAD, static_cast<size_t>(n_rows / MIN_CHUNK_ROWS)) };
+
+  if ( (pool.size() == 1) or (n_chunks <= 1) )
+    return fn(uint32_t { 0 }, n_rows);
+
+  vector<future<R>> futures;
+
+  for (size_t n { 0 }; n < n_chunks; ++n)
+  { const uint32_t first { static_cast<uint32_t>(uint64_t { n_rows } * n / n_chunks) };
+    const uint32_t last  { static_cast<uint32_t>(uint64_t { n_rows } * (n + 1) / n_chunks) };
+
+    futures += pool.submit( [&fn, &timer, first, last] (void) { return timer.charge( [&fn, first, last] (void) { return fn(first, last); } ); } );
+  }
+
+  R rv;
+
+  timer.uncharged( [&futures, &pool, &rv] (void) { for (auto& fut : futures)
+                                                   { const R chunk_results { pool.wait(fut) };
+
+                                                     rv.insert(rv.end(), chunk_results.begin(), chunk_results.end());
+                                                   }
+                                                 } );
+  return rv;
+}
+
+/*! \brief                              Generate the SCP calls from the QSOs on a band
+    \param  all_qsos_this_band          all the QSOs (for the band)
+    \param  known_calls                 rcalls that are already known to be in the SCP list; QSOs with these rcalls are pruned at the outset
+    \param  calls_with_no_freq_info     the calls that have no reliable frequency info in the log
+    \param  calls_with_poor_freq_info
+    \param  max_rel_mins                the number of minutes in the contest - 1
+    \param  calls                       table in which the calls are interned
+    \param  dirname                     directory of the contest, used only to identify the statistics
+    \param  pool                        pool across which the tcall_busts and running_busts passes are split
+    \return                             the SCP calls after adding those from the containers
+
+    D is the diagnostics policy; the diagnostic output of the instantiation is produced without changing the complexity of the processing
+*/
+template <typename D>
+call_id_set process_band(const band_log& all_qsos_this_band,
+                         const call_id_set& known_calls,
+                         const call_id_set& calls_with_no_freq_info,
+                         const call_id_set& calls_with_poor_freq_info,
+                         const int max_rel_mins,
+                         const call_table& calls,
+                         const string& dirname,
+                         thread_pool& pool)
+{ const CALL_ID   traced_id { D::tracing ? calls.find(traced_call) : NO_CALL };   // NO_CALL if the traced call does not appear in the logs
+  const band_log& all       { all_qsos_this_band };
+
+  pmr::monotonic_buffer_resource arena;             // the node-based containers of the band; released at once when the band is finished
+
+// whether a call is the traced call; always false, at compile time, unless tracing
+  auto is_traced = [traced_id] (const CALL_ID call) { return (D::tracing and (call == traced_id)); };
+
+// the pruned QSOs are the rows of all that remain under consideration; each removal clears a flag
+  vector<bool> live(all.size(), false);
+  uint32_t     n_live { 0 };                        // number of rows in live that are set
+
+  for (uint32_t row { 0 }; row < all.size(); ++row)
+  { if (!known_calls.contains(all.rcall(row)))
+    { live[row] = true;
+      n_live++;
+    }
+  }
+
+  auto remove_row = [&live, &n_live] (const uint32_t row)
+    { if (live[row])
+      { live[row] = false;
+        n_live--;
+      }
+    };
+
+// apply a function to each pruned row, in chronological order
+  auto for_all_live_rows = [&all, &live] (auto&& fn)
+    { for (uint32_t row { 0 }; row < all.size(); ++row)
+        if (live[row])
+          fn(row);
+    };
+
+  const string       band_str   { HF_BAND_STR.at(static_cast<int>(all.band())) + "m" }; // string to be used to identify the band in output
+  const call_id_set& all_tcalls { all.tcalls() };                                       // all the tcalls on this band
+
+// record the statistics of each removal stage: the stage's input is the live rows at its start
+  stage_timer timer         { STATISTICS };
+  uint32_t    n_stage_start { n_live };
+
+  auto end_stage = [&timer, &n_stage_start, &n_live, &dirname, &band_str] (const string& stage)
+    { timer.record(dirname, band_str, stage, n_stage_start, n_stage_start - n_live);
+      timer.restart();
+      n_stage_start = n_live;
+    };
+
+/*  \brief          Are two frequencies approximately the same?
+    \param  tcall1  tcall of QSO #1
+    \param  qrg1    frequency of QSO #1
+    \param  tcall2  tcall of QSO #2
+    \param  qrg2    frequency of QSO #2
+    \param  def     whether calls with no detailed frequency info suggests a frequency match
+    \return         whether QSO #1 and QSO #2 are reoughly on the same frequency (to within FREQ_SKEW kHz)
+*/
+  auto frequency_match = [&calls_with_no_freq_info, &calls_with_poor_freq_info] (const CALL_ID tcall1, const int qrg1, const CALL_ID tcall2, const int qrg2, const bool def) 
+    { if (def)
+        return ( (calls_with_no_freq_info.contains(tcall1) or calls_with_no_freq_info.contains(tcall2)) or 
+                 (calls_with_poor_freq_info.contains(tcall1) or calls_with_poor_freq_info.contains(tcall2)) or 
+                 (abs(qrg1 - qrg2) <= FREQ_SKEW) );
+      else
+// this is a fudge -- some stations have freq info for only SOME QSOs, (these stns are in calls_with_poor_freq_info).
+// This might mischaracterise QSOs close to the band edge, but I think that that's the lesser of the two evils      
+        return ( (!calls_with_no_freq_info.contains(tcall1) and !calls_with_no_freq_info.contains(tcall2)) and 
+ //                (!calls_with_poor_freq_info.contains(tcall1) and !calls_with_poor_freq_info.contains(tcall2)) and
+                 (abs(qrg1 - qrg2) <= FREQ_SKEW) ); 
+    };
+
+// look for specific QSO busts, where the frequency and time in two logs match, and an rcall is a bust of a tcall
+  uint32_t n_removed { 0 };
+
+/* go through the pruned log in chronological order; the matches are in all, so whether a row is removed does not depend
+   on whether any other row is removed, and the rows are split into chunks that are searched in parallel. Each chunk
+   returns its removals, with the match for each, which are then made, and reported, in chronological order
+*/
+  auto find_tcall_busts = [&all, &live, &calls, &calls_with_no_freq_info, &calls_with_poor_freq_info, max_rel_mins] (const uint32_t first_row, const uint32_t last_row)
+    { vector<pair<uint32_t /* rrow */, uint32_t /* match row */>> rv;
+      vector<uint8_t>                                             mask;     // which rows in a range have a tcall that is a bust of the rcall under test
+
+      for (uint32_t rrow { first_row }; rrow != last_row; ++rrow)
+      { if (!live[rrow])
+          continue;
+
+        const int target_rel_mins      { all.rel_mins(rrow) };
+        const int lower_target_minutes { max(target_rel_mins - CLOCK_SKEW, 0) };
+        const int upper_target_minutes { min(target_rel_mins + CLOCK_SKEW, max_rel_mins) };
+
+        const CALL_ID     r_tcall  { all.tcall(rrow) };
+        const int         r_qrg    { all.qrg(rrow) };
+        const packed_call r_packed { calls.call(all.rcall(rrow)) };
+
+/* every match requires that the frequencies match and that the tcall in the window be a bust of the rcall;
+   the frequencies match for every row if r_tcall's frequency information is untrustworthy, otherwise only
+   for rows within FREQ_SKEW and rows whose own tcall has untrustworthy frequency information
+*/
+        auto is_match = [&all, &calls, r_tcall] (const uint32_t trow)
+          { const CALL_ID t_rcall { all.rcall(trow) };
+
+            return ( (t_rcall == r_tcall) or is_bust(calls.call(r_tcall), calls.call(t_rcall)) );
+          };
+
+// search a range of rows, all of which match in frequency
+        auto search_rows = [&all, &is_match, &mask, &r_packed] (const uint32_t first, const uint32_t last)
+          { bust_mask(r_packed, all.packed_tcalls(first, last), mask);
+
+            for (uint32_t n { 0 }; n < mask.size(); ++n)
+              if (mask[n] and is_match(first + n))
+                return (first + n);
+
+            return last;
+          };
+
+        optional<uint32_t> match_row { };
+
+        for (int m { lower_target_minutes }; !match_row and (m <= upper_target_minutes); ++m)
+        { if (!call_has_good_freq_info(r_tcall, calls_with_no_freq_info, calls_with_poor_freq_info))
+          { const uint32_t last { all.minute_start(m + 1) };
+
+            if (const uint32_t trow { search_rows(all.minute_start(m), last) }; trow != last)
+              match_row = trow;
+          }
+          else
+          { const auto [ first, last ] { all.qrg_rows(m, r_qrg - FREQ_SKEW, r_qrg + FREQ_SKEW) };
+
+            if (const uint32_t trow { search_rows(first, last) }; trow != last)
+              match_row = trow;
+            else
+            { for (const uint32_t unreliable_row : all.unreliable_rows(m))
+              { if (is_bust(r_packed, all.packed_tcall(unreliable_row)) and is_match(unreliable_row))
+                { match_row = unreliable_row;
+                  break;
+                }
+              }
+            }
+          }
+        }
+
+        if (match_row)
+          rv.emplace_back(rrow, *match_row);
+      }
+
+      return rv;
+    };
+
+  for (const auto [ rrow, match_row ] : for_row_chunks(all.size(), pool, timer, find_tcall_busts))
+  { remove_row(rrow);
+    n_removed++;
+
+    if constexpr (D::verbose)
+      cout << band_str << ": marked for removal: " << all.to_string(rrow, calls) << "; tcall match = " << all.to_string(match_row, calls) << endl;
+
+    if (is_traced(all.rcall(rrow)))
+      cout << band_str << ": traced call " << traced_call << " marked for removal: " << all.to_string(rrow, calls) << "; tcall match = " << all.to_string(match_row, calls) << endl;
+  }
+
+  end_stage("tcall_busts"s);
+
+  if constexpr (D::verbose)
+  { cout << band_str << ": number of QSO IDs to remove: " << n_removed << endl;
+    cout << band_str << ": current number of QSOs in pruned_vec = " << n_live << endl;
+  }
+
+  if constexpr (D::tracing)
+  { int counter { 0 };
+  
+    cout << band_str << ": Remaining traced QSOs after initial removal: " << endl;
+  
+    for_all_live_rows([band_str, &calls, &counter, &all, traced_id] (const uint32_t row) { if (all.rcall(row) == traced_id)
+                                                                     { cout << "  " << band_str << ": " << all.to_string(row, calls) << endl;
+                                                                       counter++;
+                                                                     }
+                                               });
+    cout << band_str << ": Pruned number of QSOs containing traced call = " << counter << endl;
+  }
+
+  n_removed = 0;                 // reset, so can be recounted
+
+/* handle the following situation:
    A and B are entrants
    A is running
    B claims a QSO with a bust of A
@@ -487,307 +1137,535 @@ unordered_set<string> process_band(const unordered_map<string /* tcall */, vecto
    
    Below, A is the running station; B is the one with the bust in the log
 */
-  { for (const auto& qso : pruned_vec)
-    { for (const auto& tcall : all_tcalls)
-      { if (!ids_to_remove.contains(qso.id()))      // don't keep going once we know to remove it
-        { if (is_bust(tcall, qso.rcall()))
-          { const bool running { is_stn_running(tcall, qso.rel_mins(), qso.qrg(), all_tcalls, calls_with_no_freq_info, calls_with_poor_freq_info, all_qsos_this_band, all_vec,
-                                 all_time_map, 0, max_rel_mins, qso.tcall()) };
-           
-            if (running)
-            { ids_to_remove += qso.id();
-        
-              if (verbose)
-                cout << band_str << ": marked for removal because unbusted rcall is running: " << qso << "; unbusted rcall = " << tcall << endl;
-          
-              if (tracing and (qso.rcall() == traced_call))
-                cout << band_str << ": traced call " << traced_call << " marked for removal: " << qso << "; tcall match = " << tcall << endl; 
+  { const bust_index tcall_index { all_tcalls, calls };       // find the entrants that are busts of an rcall without looking at every entrant
+
+    vector<vector<CALL_ID>> tcall_busts(calls.size());     // for each rcall, the tcalls that are busts of it
+    call_id_set             examined_rcalls;                // the rcalls whose busts are in tcall_busts
+    call_id_set             busted_entrants;                // the entrants that are busts of some rcall
+
+    for_all_live_rows([&all, &calls, &tcall_index, &tcall_busts, &examined_rcalls, &busted_entrants] (const uint32_t row)
+      { if (const CALL_ID rcall { all.rcall(row) }; !examined_rcalls.contains(rcall))       // first QSO with this rcall
+        { examined_rcalls += rcall;
+          tcall_index.busts(calls.call(rcall), tcall_busts[rcall]);
+          FOR_ALL(tcall_busts[rcall], [&busted_entrants] (const CALL_ID tcall) { busted_entrants += tcall; });
+        }
+      });
+
+    const run_segments runs { all, max_rel_mins, calls.size(), calls_with_no_freq_info, calls_with_poor_freq_info, busted_entrants };  // when and where each busted entrant was running
+
+// whether a row is removed depends only on all and on the run segments, so the rows are split into chunks as in the first pass
+    auto find_running_busts = [&all, &live, &tcall_busts, &runs] (const uint32_t first_row, const uint32_t last_row)
+      { vector<pair<uint32_t /* row */, CALL_ID /* running tcall */>> rv;
+
+        for (uint32_t row { first_row }; row != last_row; ++row)
+        { if (!live[row])
+            continue;
+
+          for (const CALL_ID tcall : tcall_busts[all.rcall(row)])
+          { if (runs.is_running(tcall, all.rel_mins(row), all.qrg(row), all.tcall(row)))
+            { rv.emplace_back(row, tcall);
+              break;                                              // don't keep going once we know to remove it
             }
-          }          
+          }
         }
-      }
+
+        return rv;
+      };
+
+    for (const auto [ row, tcall ] : for_row_chunks(all.size(), pool, timer, find_running_busts))
+    { remove_row(row);
+      n_removed++;
+
+      if constexpr (D::verbose)
+        cout << band_str << ": marked for removal because unbusted rcall is running: " << all.to_string(row, calls) << "; unbusted rcall = " << calls.call(tcall) << endl;
+
+      if (is_traced(all.rcall(row)))
+        cout << band_str << ": traced call " << traced_call << " marked for removal: " << all.to_string(row, calls) << "; tcall match = " << calls.call(tcall) << endl;
     }
   }
 
-// remove the marked QSOs
-  if (!ids_to_remove.empty())
-  { if (verbose)
-      cout << "removing " << ids_to_remove.size() << " QSOs for stations determined to be running" << endl;
-      
-    erase_if(pruned_vec, [&ids_to_remove] (const small_qso& qso) { return ids_to_remove.contains(qso.id()); });
-  }
+  end_stage("running_busts"s);
 
-  if (verbose)
-    cout << "current number of QSOs in pruned_vec = " << pruned_vec.size() << endl;
+  if constexpr (D::verbose)
+  { if (n_removed)
+      cout << "removing " << n_removed << " QSOs for stations determined to be running" << endl;
 
-  if (tracing)
+    cout << "current number of QSOs in pruned_vec = " << n_live << endl;
+  }
+
+  if constexpr (D::tracing)
   { int counter { 0 };
   
     cout << band_str << ": Remaining traced QSOs after removing busts of running stations: " << endl;
   
-    FOR_ALL(pruned_vec, [band_str, &counter] (const small_qso& qso) { if (qso.rcall() == traced_call)
-                                                                     { cout << "  " << band_str << ": " << qso << endl;
+    for_all_live_rows([band_str, &calls, &counter, &all, traced_id] (const uint32_t row) { if (all.rcall(row) == traced_id)
+                                                                     { cout << "  " << band_str << ": " << all.to_string(row, calls) << endl;
                                                                        counter++;
                                                                      }
                                                });
     cout << band_str << ": Pruned number of QSOs containing traced call = " << counter << endl;
   }
 
-/* now go through pruned_vec, and for each rcall look to see if it's a bust
+/* now go through the pruned rows, and for each rcall look to see if it's a bust
    of a non-entrant (i.e., not a tcall) rcall that is running on that frequency
    
    This will be somewhat rare, as non-entrants typically do not run.
 */
-  if (verbose or tracing)
+  if constexpr (D::verbose or D::tracing)
     cout << band_str << ": now to look for non-entrant busts" << endl;
 
-// build pseudo-logs of rcalls
-  unordered_map<string /* rcall */, vector<small_qso> /* rcall log */> rcall_logs;
-  unordered_set<string>                                                rcalls;
-    
-  FOR_ALL(pruned_vec, [&rcalls, &rcall_logs] (const small_qso& qso) { rcall_logs[qso.rcall()] += qso; 
-                                                                      rcalls += qso.rcall();
-                                                                    });
+/* build pseudo-logs of rcalls: the pruned rows, grouped by rcall; because the rows are chronological, so is each pseudo-log.
+   The pseudo-logs are indices into all, so a QSO is compared with the QSOs of the busts of its rcall by searching the pseudo-log
+   of each bust in turn, without copying or sorting any rows
+*/
+  vector<uint32_t> rcall_start(calls.size() + 1, 0);         // for each rcall, the index of its first row in rcall_rows; the final element is the number of rows
+  vector<uint32_t> rcall_rows;                                // the pruned rows, grouped by rcall, and in chronological order within each group
+  call_id_set      rcalls;
 
-  for (auto& [ rcall, rcall_log ] : rcall_logs)       // sort each rcall log chronologically; C++ does not permit lambdas with structured binding
-    SORT(rcall_log);
-  
-  if (verbose)
-    cout << band_str << ": Number of rcall logs = " << rcall_logs.size() << endl;
+  for_all_live_rows([&all, &rcalls, &rcall_start] (const uint32_t row) { rcall_start[all.rcall(row) + 1]++;
+                                                                         rcalls += all.rcall(row);
+                                                                       });
+
+  partial_sum(rcall_start.begin(), rcall_start.end(), rcall_start.begin());
+  rcall_rows.resize(rcall_start.back());
+
+  { vector<uint32_t> next_posn { rcall_start };               // the next position to be filled for each rcall
+
+    for_all_live_rows([&all, &rcall_rows, &next_posn] (const uint32_t row) { rcall_rows[next_posn[all.rcall(row)]++] = row; });
+  }
+
+// the pseudo-log of an rcall; the pseudo-logs are not changed by removing rows later in this stage
+  auto rcall_log = [&rcall_start, &rcall_rows] (const CALL_ID rcall)
+    { return span<const uint32_t> { rcall_rows.data() + rcall_start[rcall], rcall_rows.data() + rcall_start[rcall + 1] }; };
+
+  if constexpr (D::verbose)
+    cout << band_str << ": Number of rcall logs = " << rcalls.size() << endl;
  
-// this can't be const as [rcall] might create an empty unordered_set later
-  unordered_map<string /* call */, unordered_set<string> /* possible_busts */> possible_rcall_busts { possible_busts(rcalls) }; // all the bust permutations in <i>rcalls</i>
+// this can't be const as [rcall] might create an empty unordered_set later; the nodes are allocated from the arena of the band
+  pmr::unordered_map<CALL_ID /* call */, pmr::unordered_set<CALL_ID> /* possible_busts */> possible_rcall_busts { possible_busts(rcalls, calls, &arena) }; // all the bust permutations in <i>rcalls</i>
 
 // count the number of times each remaining rcall appears
-  count_values<string> histogram;
+  dense_count_values<CALL_ID> histogram;
   
-  FOR_ALL(pruned_vec, [&histogram] (const small_qso& qso) { histogram += qso.rcall(); });
+  for_all_live_rows([&histogram, &all] (const uint32_t row) { histogram += all.rcall(row); });
 
-// invert the histogram, in order of greatest count to least
-  const auto inv_histogram { histogram.sorted_invert<set<string>, greater<int>>() };
-  
-  auto inv_histogram_it { inv_histogram.begin() };
-  int  counter          { 0 };
-  
-  ids_to_remove.clear();
+// group the rcalls by count, in order of greatest count to least
+  const count_buckets<CALL_ID> inv_histogram { histogram.by_count_descending() };
+
+  vector<span<const uint32_t>> bust_logs;                     // the pseudo-logs of the busts of the rcall under test
   
-  while (inv_histogram_it != inv_histogram.end())
-  { if (verbose)
-      cout << band_str << ": index = " << counter << ", count : " << inv_histogram_it->first << endl;
+  for (size_t counter { 0 }; counter < inv_histogram.size(); ++counter)
+  { if constexpr (D::verbose)
+      cout << band_str << ": index = " << counter << ", count : " << inv_histogram.count(counter) << endl;
 
-    const set<string> rcalls_this_count { inv_histogram_it->second };
+    const span<const CALL_ID> rcalls_this_count { inv_histogram.values(counter) };
   
-    if (verbose)
+    if constexpr (D::verbose)
       cout << band_str << ": number of rcalls = " << rcalls_this_count.size() << endl;
   
     for (const auto& rcall : rcalls_this_count)
-    { if (verbose)
-        cout << band_str << ": rcall = " << rcall << endl;
+    { if constexpr (D::verbose)
+        cout << band_str << ": rcall = " << calls.call(rcall) << endl;
  
-       if (tracing and (rcall == traced_call))
-         cout << band_str << ": testing " << rcall << " under inv_histogram count = " << inv_histogram_it->first << endl;
+       if (is_traced(rcall))
+         cout << band_str << ": testing " << traced_call << " under inv_histogram count = " << inv_histogram.count(counter) << endl;
  
-      vector<small_qso> log_of_rcall_and_busts { rcall_logs[rcall] };   // start with the log of this rcall
+      const span<const uint32_t> log_of_rcall { rcall_log(rcall) };
  
-      if (tracing and (traced_call == rcall))
+      if (is_traced(rcall))
       { cout << band_str << ": all QSOs with this rcall: " << endl;
-        FOR_ALL(rcall_logs.at(rcall), [&band_str] (const small_qso& qso) { cout << "  " << band_str << ": " << qso << endl; });
+        FOR_ALL(log_of_rcall, [&band_str, &calls, &all] (const uint32_t row) { cout << "  " << band_str << ": " << all.to_string(row, calls) << endl; });
+      }
+
+// for each of the QSOs in the pseudo-log of rcall, see if it's a run QSO of a bust of rcall
+      const pmr::unordered_set<CALL_ID>& rcall_busts { possible_rcall_busts[rcall] };  // all the busts of this rcall; do not use .at() here, as [rcall] will have no entry if there are no busts of rcall 
+
+      if (is_traced(rcall))
+      { cout << band_str << ": number of rcall busts = " << rcall_busts.size() << endl;
+        
+        CALL_SET ordered_rcall_busts(compare_calls);
+        
+        FOR_ALL(rcall_busts,         [&calls, &ordered_rcall_busts] (const CALL_ID rcall_bust) { ordered_rcall_busts += calls.call(rcall_bust); });
+        FOR_ALL(ordered_rcall_busts, [&band_str]            (const string& rcall_bust) { cout << band_str << ":  " << rcall_bust << endl; });
+      }
+
+      bust_logs.clear();
+
+      for (const CALL_ID rcall_bust : rcall_busts)
+        if (const span<const uint32_t> log { rcall_log(rcall_bust) }; !log.empty())
+          bust_logs += log;
+
+      if (is_traced(rcall))                   // only the diagnostic output needs the combined log in chronological order
+      { vector<uint32_t> log_of_rcall_and_busts { log_of_rcall.begin(), log_of_rcall.end() };
+
+        FOR_ALL(bust_logs, [&log_of_rcall_and_busts] (const span<const uint32_t> log) { log_of_rcall_and_busts.insert(log_of_rcall_and_busts.end(), log.begin(), log.end()); });
+        SORT(log_of_rcall_and_busts);
+
+        cout << "combined log for " << traced_call << " and all its busts:" << endl;
+        FOR_ALL(log_of_rcall_and_busts, [&band_str, &calls, &all] (const uint32_t row) { cout << band_str << ":  " << all.to_string(row, calls) << endl; });
+      }
+
+      for (const uint32_t rrow : log_of_rcall)
+      { if (is_traced(rcall))
+          cout << band_str << ": testing whether QSO is in a run: " << all.to_string(rrow, calls) << endl;
+
+        if (D::verbose or is_traced(rcall))       // the time range of the QSOs of rcall and its busts in the window
+        { const int target_minutes       { all.rel_mins(rrow) };
+          const int lower_target_minutes { max(target_minutes - RUN_TIME_RANGE, 0) };
+          const int upper_target_minutes { min(target_minutes + RUN_TIME_RANGE, max_rel_mins) }; 
+
+          const auto [ lb, ub ] { get_bounds(target_minutes, 0, max_rel_mins, RUN_TIME_RANGE, log_of_rcall, all) };      // always includes rrow
+
+          int low_rel_mins  { all.rel_mins(*lb) };
+          int high_rel_mins { all.rel_mins(*prev(ub)) }; 
+
+          for (const span<const uint32_t> log : bust_logs)
+          { if (const auto [ blb, bub ] { get_bounds(target_minutes, 0, max_rel_mins, RUN_TIME_RANGE, log, all) }; blb != bub)
+            { low_rel_mins = min(low_rel_mins, all.rel_mins(*blb));
+              high_rel_mins = max(high_rel_mins, all.rel_mins(*prev(bub)));
+            }
+          }
+        
+          cout << band_str << ": time range: " << low_rel_mins << " to " << high_rel_mins
+               << " for target time = " << target_minutes << "; lower target = " << lower_target_minutes << ", upper target = " << upper_target_minutes << endl;
+        }
+
+        const CALL_ID r_tcall { all.tcall(rrow) };
+        const int     r_qrg   { all.qrg(rrow) };
+
+// look for a QSO of a bust of rcall in the window, on the same frequency; the verbose output reports the earliest such QSO,
+// so the search stops at the first match only if there is no verbose output
+        optional<uint32_t> match_row { };
+
+        for (const span<const uint32_t> log : bust_logs)
+        { const auto [ lb, ub ] { get_bounds(all.rel_mins(rrow), 0, max_rel_mins, RUN_TIME_RANGE, log, all) };
+          const auto it         { find_if(lb, ub, [&frequency_match, &all, r_tcall, r_qrg] (const uint32_t row) { return frequency_match(all.tcall(row), all.qrg(row), r_tcall, r_qrg, false); }) };
+
+          if ( (it != ub) and (!match_row or (*it < *match_row)) )
+          { match_row = *it;
+
+            if constexpr (!D::verbose)
+              break;
+          }
+        }
+
+        const bool run_qso { match_row.has_value() };
+
+        if constexpr (D::verbose)
+        { if (run_qso)
+          { const CALL_ID tcall { all.tcall(*match_row) };
+
+            cout << "MATCH: " << all.to_string(*match_row, calls) << " | " << all.to_string(rrow, calls) << endl;
+            cout << "  freq info1: " << calls_with_no_freq_info.contains(tcall)  << endl;
+            cout << "  freq info2: " << calls_with_no_freq_info.contains(r_tcall)  << endl;
+            cout << "  comparison: " << (abs(all.qrg(*match_row) - r_qrg) <= 2) << endl;
+          }
+        }
+          
+        if (D::verbose or is_traced(rcall))
+          cout << band_str << ": run_qso = " << boolalpha << run_qso << endl;
+
+        if (run_qso)                                  // the pseudo-logs are already built, so removing the row at once does not affect later rows
+        { remove_row(rrow);
+         
+          if (is_traced(rcall))
+            cout << band_str << ": traced call " << traced_call << " marked for removal: " << all.to_string(rrow, calls) << endl;
+        }
       }
+    }
+  }
+  
+  end_stage("non_entrant_busts"s);
+
+  if constexpr (D::verbose)
+    cout << band_str << ": Number of remaining calls after processing busts for possible runs = " << n_live << endl;
+
+// regenerate the histogram and remove the calls with too few occurrences
+  histogram.clear();
+
+  for_all_live_rows([&histogram, &all] (const uint32_t row) { histogram += all.rcall(row); });
+
+// remove all the rcalls that are at or below CUTOFF_LIMIT (default = 1)
+  if constexpr (D::verbose)
+  { cout << band_str << ": Erasing calls below CUTOFF_LIMIT ( = " << CUTOFF_LIMIT << " )" << endl;
+
+    for (const CALL_ID rcall : histogram)
+      if (histogram[rcall] <= CUTOFF_LIMIT)
+        cout << band_str << ": Erasing call: " << calls.call(rcall) << endl;
+  }
+
+  for_all_live_rows([&all, &histogram, &remove_row] (const uint32_t row) { if (histogram[all.rcall(row)] <= CUTOFF_LIMIT)
+                                                                              remove_row(row);
+                                                                          });
+
+  end_stage("cutoff"s);
+
+  if constexpr (D::verbose)
+    cout << band_str << ": final number of QSOs in pruned_vec = " << n_live << endl;
+
+// add the remaining rcalls to local_scp_calls
+  call_id_set local_scp_calls { };
+
+  for_all_live_rows([&all, &local_scp_calls] (const uint32_t row) { local_scp_calls += all.rcall(row); } );   // NB will try to add many times, but should be fast
+
+  if constexpr (D::verbose)
+  { FOR_ALL(local_scp_calls, [&calls] (const CALL_ID call) { cout << calls.call(call) << endl; } );
+    cout << band_str << ": final number of SCP calls = " << local_scp_calls.size() << endl;
+  }
+  
+  return local_scp_calls;
+}
+
+/*! \brief                              Generate the SCP calls from the QSOs on a band, with the diagnostics selected by -v and -tr
+    \param  all_qsos_this_band          all the QSOs (for the band)
+    \param  known_calls                 rcalls that are already known to be in the SCP list; QSOs with these rcalls are pruned at the outset
+    \param  calls_with_no_freq_info     the calls that have no reliable frequency info in the log
+    \param  calls_with_poor_freq_info
+    \param  max_rel_mins                the number of minutes in the contest - 1
+    \param  calls                       table in which the calls are interned
+    \param  dirname                     directory of the contest, used only to identify the statistics
+    \param  pool                        pool across which the tcall_busts and running_busts passes are split
+    \return                             the SCP calls after adding those from the containers
+*/
+call_id_set process_band(const band_log& all_qsos_this_band,
+                         const call_id_set& known_calls,
+                         const call_id_set& calls_with_no_freq_info,
+                         const call_id_set& calls_with_poor_freq_info,
+                         const int max_rel_mins,
+                         const call_table& calls,
+                         const string& dirname,
+                         thread_pool& pool)
+{ if (verbose)
+    return (tracing ? process_band<VERBOSE_TRACE_DIAGNOSTICS>(all_qsos_this_band, known_calls, calls_with_no_freq_info, calls_with_poor_freq_info, max_rel_mins, calls, dirname, pool)
+                    : process_band<VERBOSE_DIAGNOSTICS>(all_qsos_this_band, known_calls, calls_with_no_freq_info, calls_with_poor_freq_info, max_rel_mins, calls, dirname, pool));
+
+  return (tracing ? process_band<TRACE_DIAGNOSTICS>(all_qsos_this_band, known_calls, calls_with_no_freq_info, calls_with_poor_freq_info, max_rel_mins, calls, dirname, pool)
+                  : process_band<QUIET_DIAGNOSTICS>(all_qsos_this_band, known_calls, calls_with_no_freq_info, calls_with_poor_freq_info, max_rel_mins, calls, dirname, pool));
+}
+
+/*! \brief                  Does a band contain any QSO that is not pruned at the outset?
+    \param  bl              the QSOs on the band
+    \param  known_calls     rcalls that are already known to be in the SCP list
+    \return                 whether any QSO in <i>bl</i> has an rcall that is not in <i>known_calls</i>
+*/
+bool has_pruned_qsos(const band_log& bl, const call_id_set& known_calls)
+{ for (uint32_t row { 0 }; row < bl.size(); ++row)
+    if (!known_calls.contains(bl.rcall(row)))
+      return true;
+
+  return false;
+}
+
+/*! \brief          Obtain the amount of log data in a directory
+    \param  cp      directory, start and duration
+    \return         the total size of the logs in <i>cp.directory()</i>, in bytes, and the number of logs
+*/
+pair<uint64_t /* bytes */, size_t /* logs */> log_sizes(const contest_parameters& cp)
+{ const vector<string> filenames { files_in_directory(cp.directory(), LINKS::INCLUDE) };
 
-// for each of the QSOs in rcall_logs[rcall], see if it's a run QSO of a bust of rcall
-      const unordered_set<string> rcall_busts { possible_rcall_busts[rcall] };  // all the busts of this rcall; do not use .at() here, as [rcall] will have no entry if there are no busts of rcall 
+  uint64_t log_bytes { 0 };
 
-      if (tracing and (rcall == traced_call))
-      { cout << band_str << ": number of rcall busts = " << rcall_busts.size() << endl;
-        
-        CALL_SET ordered_rcall_busts(compare_calls);
-        
-        FOR_ALL(rcall_busts,         [&ordered_rcall_busts] (const string& rcall_bust) { ordered_rcall_busts += rcall_bust; });
-        FOR_ALL(ordered_rcall_busts, [&band_str]            (const string& rcall_bust) { cout << band_str << ":  " << rcall_bust << endl; });
-      }
-    
-      FOR_ALL(rcall_busts, [&log_of_rcall_and_busts, &rcall_logs] (const string& rcall_bust) { log_of_rcall_and_busts += rcall_logs[rcall_bust]; } );
-      SORT(log_of_rcall_and_busts);             // put the combined log for rcall and all its busts into chronological order
+  FOR_ALL(filenames, [&log_bytes] (const string& filename) { log_bytes += file_size(filename); });
 
-      if (tracing and (rcall == traced_call))
-      { cout << "combined log for " << rcall << " and all its busts:" << endl;
-        FOR_ALL(log_of_rcall_and_busts, [&band_str] (const small_qso& qso) { cout << band_str << ":  " << qso << endl; });
-      }
+  return { log_bytes, filenames.size() };
+}
 
-      for (const small_qso& rqso : rcall_logs[rcall])
-      { if (tracing and (rcall == traced_call))
-          cout << band_str << ": testing whether QSO is in a run: " << rqso << endl;
+/*! \brief          Estimate the memory needed to process a directory
+    \param  cp      directory, start and duration
+    \return         estimated peak memory needed to process the logs in <i>cp.directory()</i>, in bytes
+*/
+uint64_t estimated_footprint(const contest_parameters& cp)
+  { return static_cast<uint64_t>(log_sizes(cp).first * FOOTPRINT_PER_LOG_BYTE); }
 
-        const auto [ lb, ub ] { get_bounds(rqso.rel_mins(), 0, max_rel_mins, RUN_TIME_RANGE, log_of_rcall_and_busts) };
-        
-        if (verbose or (tracing and (rcall == traced_call)))
-        { const int target_minutes       { rqso.rel_mins() };
-          const int lower_target_minutes { max(target_minutes - RUN_TIME_RANGE, 0) };
-          const int upper_target_minutes { min(target_minutes + RUN_TIME_RANGE, max_rel_mins) }; 
-          const int low_rel_mins         { lb->rel_mins() };
-          const int high_rel_mins        { prev(ub)->rel_mins() }; 
-        
-          cout << band_str << ": time range: " << low_rel_mins << " to " << high_rel_mins
-               << " for target time = " << target_minutes << "; lower target = " << lower_target_minutes << ", upper target = " << upper_target_minutes << endl;
-        }
+/*! \brief                              Generate the SCP calls from the QSOs on each band, one band at a time, by way of spill files
+    \param  all_qsos                    all the QSOs, per entrant's call; emptied on return
+    \param  known_calls                 rcalls that are already known to be in the SCP list
+    \param  calls_with_no_freq_info     the calls that have no reliable frequency info in the log
+    \param  calls_with_poor_freq_info   entrants whose logged frequency information is untrustworthy
+    \param  max_rel_mins                the number of minutes in the contest - 1
+    \param  calls                       table in which the calls are interned
+    \param  dirname                     directory of the contest
+    \param  timer                       timer of the stages
+    \param  pool                        pool across which the passes over each band are split
+    \return                             the SCP calls from each band that was processed
+
+    The QSOs are written to one spill file per band, and released; then each band in turn is mapped from its file
+    and processed, so only one band's QSOs are in memory at once. The QSOs of each band are written in the order in
+    which build_minilog() takes them, so the result is the same as that of processing all the bands at once.
+*/
+vector<call_id_set> process_bands_from_spill(unordered_map<CALL_ID /* tcall */, vector<small_qso>>& all_qsos, const call_id_set& known_calls,
+                                             const call_id_set& calls_with_no_freq_info, const call_id_set& calls_with_poor_freq_info,
+                                             const int max_rel_mins, const call_table& calls, const string& dirname, stage_timer& timer,
+                                             thread_pool& pool)
+{ static_assert(is_trivially_copyable_v<small_qso>, "small_qso cannot be spilled");
 
-        const bool run_qso { ANY_OF(lb, ub, [&calls_with_no_freq_info, &frequency_match, &rcall, &rqso] (const small_qso& qso) 
-                                      { if (qso.rcall() == rcall) // select only ones with different call
-                                          return false;
-                                                                            
-                                        if (verbose and frequency_match(qso, rqso, false))
-                                        { cout << "MATCH: " << qso << " | " << rqso << endl;
-                                          cout << "  freq info1: " << calls_with_no_freq_info.contains(qso.tcall())  << endl;
-                                          cout << "  freq info2: " << calls_with_no_freq_info.contains(rqso.tcall())  << endl;
-                                          cout << "  comparison: " << (abs(qso.qrg() - rqso.qrg()) <= 2) << endl;
-                                        }
-                                                                            
-                                        return frequency_match(qso, rqso, false);        // use frequency_match lambda
-                                      } ) };
-          
-        if (verbose or (tracing and (rcall == traced_call)))
-          cout << band_str << ": run_qso = " << boolalpha << run_qso << endl;
+  constexpr size_t N_BANDS { static_cast<size_t>(HF_BAND::BAD) };   // QSOs on a bad band are never processed
 
-        if (run_qso)
-        { ids_to_remove += rqso.id();
-         
-          if (tracing and (rcall == traced_call))
-            cout << band_str << ": traced call " << traced_call << " marked for removal: " << rqso << endl;
+  const string spill_base { (filesystem::temp_directory_path() / ("drscp-"s + to_string(getpid()) + "-"s + to_string(spill_serial++))).string() };
+
+  array<string, N_BANDS> spill_filenames;
+  array<size_t, N_BANDS> n_spilled { };
+
+  { array<ofstream, N_BANDS> spill_files;
+
+    for (size_t b { 0 }; b < N_BANDS; ++b)
+    { spill_filenames[b] = spill_base + "-"s + HF_BAND_STR[b] + ".spill"s;
+      spill_files[b].open(spill_filenames[b], ios::binary | ios::trunc);
+    }
+
+    for (const auto& [ tcall, qsos ] : all_qsos)
+      for (const small_qso& qso : qsos)
+        if (const size_t b { static_cast<size_t>(qso.band()) }; b < N_BANDS)
+        { spill_files[b].write(reinterpret_cast<const char*>(&qso), sizeof(qso));
+          n_spilled[b]++;
         }
+
+    for (auto& spill_file : spill_files)
+    { if (spill_file.close(), !spill_file)
+      { cerr << "ERROR: unable to write spill files: " << spill_base << endl;
+        exit(-1);
       }
     }
-    
-    inv_histogram_it++;
-    counter++;
   }
-  
-// remove the QSOs marked for removal
-  erase_if(pruned_vec, [&ids_to_remove] (const small_qso& qso) { return ids_to_remove.contains(qso.id()); });
 
-  if (verbose)
-    cout << band_str << ": Number of remaining calls after processing busts for possible runs = " << pruned_vec.size() << endl;
+  const int64_t n_qsos { accumulate(n_spilled.cbegin(), n_spilled.cend(), int64_t { 0 }) };
 
-// regenerate the histogram and remove the calls with too few occurrences
-  histogram.clear();
+  all_qsos.clear();
 
-  FOR_ALL(pruned_vec, [&histogram] (const small_qso& qso) { histogram += qso.rcall(); });
+  timer.record(dirname, ""s, "spill"s, n_qsos);
 
-// remove all the rcalls that are at or below CUTOFF_LIMIT (default = 1)
-  if (verbose)
-  { cout << band_str << ": Erasing calls below CUTOFF_LIMIT ( = " << CUTOFF_LIMIT << " )" << endl;
+  vector<call_id_set> rv;
 
-    for (auto& [ rcall, count ] : histogram)
-    { if (count <= CUTOFF_LIMIT)
-      { cout << band_str << ": Erasing call: " << rcall << endl;
-         
-        erase_if(pruned_vec, [&rcall] (const small_qso& qso) { return (qso.rcall() == rcall); });
+  for (size_t b { 0 }; b < N_BANDS; ++b)
+  { optional<band_log> bl;
+
+    timer.restart();
+
+    if (n_spilled[b])
+    { memory_mapped_file     spill_file { spill_filenames[b] };
+      binary_reader          br         { spill_file.contents() };
+      span<const small_qso>  qsos       { br.get_span<small_qso>(n_spilled[b]) };
+
+      if (!br.good())
+      { cerr << "ERROR: unable to read spill file: " << spill_filenames[b] << endl;
+        exit(-1);
       }
+
+      vector<const small_qso*> qso_ptrs;
+
+      qso_ptrs.reserve(qsos.size());
+      FOR_ALL(qsos, [&qso_ptrs] (const small_qso& qso) { qso_ptrs += &qso; });
+
+      bl.emplace(static_cast<HF_BAND>(b), qso_ptrs, max_rel_mins, calls, calls_with_no_freq_info, calls_with_poor_freq_info);
     }
-    
-    cout << band_str << ": final number of QSOs in pruned_vec = " << pruned_vec.size() << endl;
-  }  
-  else  // not verbose
-    erase_if(pruned_vec, [&histogram] (const small_qso& qso) { return (histogram.at(qso.rcall()) <= CUTOFF_LIMIT); });
 
-// add the remaining rcalls to local_scp_calls
-  unordered_set<string> local_scp_calls { };
+    file_delete(spill_filenames[b]);
 
-  FOR_ALL(pruned_vec, [&local_scp_calls] (const small_qso& qso) { local_scp_calls += qso.rcall(); } );   // NB will try to add many times, but should be fast
+    if (bl)
+    { timer.record(dirname, HF_BAND_STR[b] + "m"s, "build_minilog"s, bl->size());
 
-  if (verbose)
-  { FOR_ALL(local_scp_calls, [] (const string& call) { cout << call << endl; } );
-    cout << band_str << ": final number of SCP calls = " << local_scp_calls.size() << endl;
+      if (has_pruned_qsos(*bl, known_calls))
+        rv += process_band(*bl, known_calls, calls_with_no_freq_info, calls_with_poor_freq_info, max_rel_mins, calls, dirname, pool);
+    }
   }
-  
-  return local_scp_calls;
+
+  return rv;
 }
 
-/*! \brief      Process all the logs in a directory
-    \param  cp  directory, start and duration
-    \return     the SCP calls for the logs in directory <i>dirname </i>
+/*! \brief          Process all the logs in a directory
+    \param  cp      directory, start and duration
+    \param  pool    pool on which to process the bands
+    \return         the SCP calls for the logs in directory <i>dirname </i>
 */
-CALL_MAP process_directory(const contest_parameters& cp)
+collated_calls process_directory(const contest_parameters& cp, thread_pool& pool)
 { const string& dirname { cp.directory() };
 
-  unordered_set<string>                                scp_calls;               // the calls in the SCP list
-  unordered_map<string /* tcall */, vector<small_qso>> all_qsos;                // all QSOs as recorded in the logs
-  unordered_map<string /* tcall */, vector<small_qso>> pruned_qsos;             // some QSOs removed, removing more as we go along
-  int                                                  n_valid_logs    { 0 };
-  int                                                  max_rel_mins    { cp.hours() * 60 - 1 };   // maximum legal value
+  stage_timer directory_timer { STATISTICS, true };     // the whole directory
+  stage_timer timer           { STATISTICS };           // each stage in turn
 
-  const string_view legal_chars { "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890/"sv };  // all the chars that are legal in callsigns
-  
-  for (const string& logfile_name : files_in_directory(dirname, LINKS::INCLUDE))
-  { unordered_map<string /* tcall */, vector<small_qso>> tcall_qsos;    // do not assume that the tcall doesn't change within the log
+  auto record_directory = [&directory_timer, &dirname] (const int64_t n_qsos)
+    { if (STATISTICS.enabled())                         // the CPU time of the directory is that of its stages
+        STATISTICS += stage_stats { dirname, ""s, "directory"s, directory_timer.wall_secs(), STATISTICS.cpu_secs(dirname), n_qsos, 0 };
+    };
 
-    const string prepared_content { to_upper(squash(replace_char(read_file(logfile_name), '\t', ' '))) }; // force this to be an lvalue
+  call_id_set                                           scp_calls;               // the calls in the SCP list
+  unordered_map<CALL_ID /* tcall */, vector<small_qso>> all_qsos;                // all QSOs as recorded in the logs
+  int                                                   n_valid_logs    { 0 };
+  int                                                   max_rel_mins    { cp.hours() * 60 - 1 };   // maximum legal value
 
-    for (const auto line : to_lines_sv(prepared_content))       // a rather minor improvement in efficientcy
-    { if (line.starts_with("QSO:"sv))
-      { small_qso qso { line };
- 
-        if (!cp.in_contest_period(qso.time()))
-          continue;
-        
-        qso.rel_mins( (qso.time() - cp.t_start()) / 60 );       // minutes since the start of the contest
-        
-        if (!qso.tcall().empty())                               // if we successfully constructed a valid QSO
-        { const string qt     { qso.tcall() };
-          const string qr     { qso.rcall() };
-          const char   tfirst { qt[0] };
-          const char   rfirst { qr[0] };
-          
-          if ( (tfirst == '/') or (rfirst == '/') or
-               (tfirst == 'Q') or (rfirst == 'Q') or
-               (tfirst == '0') or (rfirst == '0') )
-            continue;
+  const vector<string> logfile_names { files_in_directory(dirname, LINKS::INCLUDE) };
 
-          const char tlast  { qt[qt.size() - 1] };
-          const char rlast  { qr[qr.size() - 1] };
-          
-          if ( (tlast== '/') or (rlast == '/') )
-            continue;            
-          
-          qso.tcall(remove_from_end(qso.tcall(), "/QRP"s));     // obviously
-          qso.rcall(remove_from_end(qso.rcall(), "/QRP"s));     //    do.
-          qso.tcall(remove_from_end(qso.tcall(), "/QRPP"s));    // yup... some people do this
-          qso.rcall(remove_from_end(qso.rcall(), "/QRPP"s));
-        
-          if ((qt.size() < 3) or (qr.size() < 3))
-            continue;
+  const bool   caching           { !CACHE_DIRECTORY.empty() };
+  const string parameters        { call_parameters() };     // the parameters that affect the calls
+  const string logs_key          { caching ? log_cache_key(cp, logfile_names) : string { } };
+  const string calls_key         { logs_key + parameters + "\n"s };
+  const string call_map_filename { caching ? call_map_cache_filename(CACHE_DIRECTORY, dirname, parameters) : string { } };
 
-          if ( (qt.find_first_not_of(legal_chars) != string::npos) or (qr.find_first_not_of(legal_chars) != string::npos) )
-            continue;
-          
-          if (qt == qr)                     // some people "work themselves" to mark bad QSOs but to keep serial numbers intact
-            continue;
- 
-          if (tracing and (qso.rcall() == traced_call))
-            cout << "Read traced call from log: " << qso << endl;
+// reuse the calls from an earlier run with the same inputs and parameters, unless the processing itself is to be reported
+  if (caching and !verbose and !tracing and !DISPLAY_BAD_QSOS)
+  { if (optional<collated_calls> cached_calls { read_call_map_cache(call_map_filename, calls_key) }; cached_calls)
+    { timer.record(dirname, ""s, "call_cache"s, 0);
+      record_directory(0);
 
-          tcall_qsos[qso.tcall()] += move(qso);
-        }
-      }
+      return move(*cached_calls);
     }
+  }
 
-    if (!tcall_qsos.empty())
-    { n_valid_logs++;
-      
-      for (auto& [ tcall, qsos ] : tcall_qsos)
-      { all_qsos += { tcall, qsos };
- 
-        if (ssize(qsos) >= TL_LIMIT)
-          scp_calls += tcall;                             // put all the tcalls into scp_calls.
-        else
-        { if (verbose)
-            cout << logfile_name << ": log size too small for tcall: " << tcall << endl;
-        }
+  stage_timer  ingestion_timer { STATISTICS, true };
+  contest_logs logs            { read_logs(cp, logfile_names, logs_key, pool, ingestion_timer) };
+
+  ingestion_timer.record(dirname, ""s, "ingestion"s, logs.qsos().size(), accumulate(logs.rejects().cbegin(), logs.rejects().cend(), 0));
+  timer.restart();
+
+  const call_table& calls { logs.calls() };                                     // all the calls in the logs; QSOs refer to calls by identifier
+  const int         id_base { qso_id.fetch_add(logs.n_qso_lines()) };          // identifier of the first QSO line in the directory
+
+// take the groups of QSOs log by log, exactly as if the logs had been read one after another
+  for (size_t g { 0 }; g < logs.n_groups(); )
+  { const uint32_t log_index { logs.group_log(g) };
+
+    vector<small_qso> traced_qsos;                                              // QSOs with the traced call, in the order of the lines in the log
+
+    n_valid_logs++;                                                             // every log with a group contains valid QSOs
+
+    for ( ; (g < logs.n_groups()) and (logs.group_log(g) == log_index); ++g)
+    { const CALL_ID   tcall { logs.group_tcall(g) };
+      vector<small_qso> qsos  ( logs.group_qsos(g).begin(), logs.group_qsos(g).end() );
+
+      FOR_ALL(qsos, [id_base] (small_qso& qso) { qso.id(qso.id() + id_base); });
+
+      if (tracing)
+        FOR_ALL(qsos, [&calls, &traced_qsos] (const small_qso& qso) { if (calls.call(qso.rcall()) == traced_call)
+                                                                        traced_qsos += qso;
+                                                                    });
+
+      if (ssize(qsos) >= TL_LIMIT)
+        scp_calls += tcall;                             // put all the tcalls into scp_calls.
+      else
+      { if (verbose)
+          cout << logfile_names[log_index] << ": log size too small for tcall: " << calls.call(tcall) << endl;
       }
+
+      all_qsos.try_emplace(tcall, move(qsos));          // the first log with a particular tcall provides its QSOs
     }
+
+    SORT(traced_qsos, [] (const small_qso& qso1, const small_qso& qso2) { return (qso1.id() < qso2.id()); });
+
+    FOR_ALL(traced_qsos, [&calls] (const small_qso& qso) { cout << "Read traced call from log: " << qso.to_string(calls) << endl; });
   }
+
+  logs.release_qsos();                                  // all_qsos now holds all the QSOs
   
   if (verbose)
+  { const auto& rejects { logs.rejects() };
+
     cout << dirname << ": total number of logs with valid QSOs = " << n_valid_logs << endl;
+    cout << dirname << ": total number of rejected QSO lines = " << accumulate(rejects.cbegin(), rejects.cend(), 0) << endl;
+
+    for (size_t n { 0 }; n < QSO_REJECT_STR.size(); ++n)
+      if (const int n_rejects { rejects[n] }; n_rejects)
+        cout << dirname << ":   " << QSO_REJECT_STR[n] << ": " << n_rejects << endl;
+  }
 
   if (n_valid_logs == 0)
   { cerr << "ERROR: no valid received logs" << endl;
@@ -806,32 +1684,32 @@ CALL_MAP process_directory(const contest_parameters& cp)
   if (verbose)
     cout << dirname << ": minutes in contest = " << max_time_range << endl;
 
-// start with the pruned QSOs being identical to all_qsos
-  pruned_qsos = all_qsos;
-
-// prune all the QSOs for which the rcall is is a known tcall (regardless of whether anything else matches)
-// also put those rcalls into the output map
-  CALL_MAP scp_cm(compare_calls);
+// the QSOs for which the rcall is is a known tcall are pruned (regardless of whether anything else matches); process_band
+// does so without copying the QSOs. Count every rcall for the output map, so that the QSOs are not needed once the bands
+// have been processed; the counts are indexed by call identifier
+  vector<int> call_counts(calls.size(), 0);
+  int         n_pruned_logs { 0 };          // number of logs that contain at least one QSO that is not pruned
   
-  for ( auto& [ tcall, qsos ] : pruned_qsos )
-  { for (const auto& qso : qsos)
-      if (scp_calls.contains(qso.rcall()))
-        scp_cm += qso.rcall();
-        
-    erase_if(qsos, [scp_calls] (const small_qso& qso) { return scp_calls.contains(qso.rcall()); } );
-  }
+  for (const auto& [ tcall, qsos ] : all_qsos)
+  { bool pruned_qsos_remain { false };
 
-  if (verbose)
-    cout << dirname << ": nlogs = " << all_qsos.size() << endl;
-  
-// remove any logs for which all the rcalls are already in scp_calls
-  erase_if(pruned_qsos, [] (const auto& pr) { return pr.second.empty(); } );
+    for (const auto& qso : qsos)
+    { call_counts[qso.rcall()]++;
+
+      if (!scp_calls.contains(qso.rcall()))
+        pruned_qsos_remain = true;
+    }
+
+    n_pruned_logs += (pruned_qsos_remain ? 1 : 0);
+  }
 
   if (verbose)
-    cout << dirname << ": pruned nlogs after removing rcalls in scp_calls = " << pruned_qsos.size() << endl;
+  { cout << dirname << ": nlogs = " << all_qsos.size() << endl;
+    cout << dirname << ": pruned nlogs after removing rcalls in scp_calls = " << n_pruned_logs << endl;
+  }
 
 // at some point we shall need a container of calls that do not have frequency info in the log
-  unordered_set<string> calls_with_no_freq_info;
+  call_id_set calls_with_no_freq_info;
   
   for (const auto& [ tcall, qsos ] : all_qsos)
   { static const set<int> default_band_freq { 1800, 3500, 7000, 14000, 21000, 28000 };  // if all frequencies are from this set, then there is no frequency info
@@ -843,7 +1721,15 @@ CALL_MAP process_directory(const contest_parameters& cp)
   if (verbose)
     cout << dirname << ": Number of logs with no frequency info = " << calls_with_no_freq_info.size() << endl;
 
-  const unordered_set<string> calls_with_poor_freq_info { calls_with_unreliable_freq(all_qsos, calls_with_no_freq_info) };
+  const int64_t n_qsos { STATISTICS.enabled() ? accumulate(all_qsos.cbegin(), all_qsos.cend(), int64_t { 0 }, [] (const int64_t n, const auto& pr) { return n + ssize(pr.second); }) : 0 };
+
+  timer.record(dirname, ""s, "prepare"s, n_qsos);
+
+  stage_timer       unreliable_timer          { STATISTICS, true };
+  const call_id_set calls_with_poor_freq_info { calls_with_unreliable_freq(all_qsos, calls_with_no_freq_info, calls.size(), pool, unreliable_timer) };
+
+  unreliable_timer.record(dirname, ""s, "unreliable_freq"s, n_qsos);
+  timer.restart();
   
   if (verbose)
     cout << dirname << ": Number of logs with unreliable frequency info = " << calls_with_poor_freq_info.size() << endl;
@@ -851,9 +1737,11 @@ CALL_MAP process_directory(const contest_parameters& cp)
   if (tracing)
   { cout << "In chronological order, all QSOs with traced call: " << traced_call << endl;
     
+    const CALL_ID traced_id { calls.find(traced_call) };
+    
     int counter { 0 };
-    FOR_ALL(build_vec(all_qsos), [&counter] (const small_qso& qso) { if (qso.rcall() == traced_call)
-                                                                     { cout << "  " << qso << endl;
+    FOR_ALL(build_vec(all_qsos), [&calls, &counter, traced_id] (const small_qso& qso) { if (qso.rcall() == traced_id)
+                                                                     { cout << "  " << qso.to_string(calls) << endl;
                                                                        counter++;
                                                                      }
                                                                    });
@@ -863,57 +1751,70 @@ CALL_MAP process_directory(const contest_parameters& cp)
     counter = 0;
     
     cout << "In chronological order, all remaining QSOs with traced call: " << traced_call << endl;
-    FOR_ALL(build_vec(pruned_qsos), [&counter] (const small_qso& qso) { if (qso.rcall() == traced_call)
-                                                                          { cout << "  " << qso << endl;
-                                                                            counter++;
-                                                                          }
-                                                                      });
+
+    if (!scp_calls.contains(traced_id))       // otherwise all the QSOs with the traced call are pruned
+      FOR_ALL(build_vec(all_qsos), [&calls, &counter, traced_id] (const small_qso& qso) { if (qso.rcall() == traced_id)
+                                                                       { cout << "  " << qso.to_string(calls) << endl;
+                                                                         counter++;
+                                                                       }
+                                                                     });
                                                               
     cout << "pruned number of QSOs containing traced call = " << counter << endl;
   }
 
 // remove QSOs for which the rcall appears to be a bust of another station's tcall
 
-// build minilogs for each band and call
-  const unordered_map<HF_BAND, decltype(all_qsos)> all_per_band_qsos    { build_minilog(all_qsos) };
-  const unordered_map<HF_BAND, decltype(all_qsos)> pruned_per_band_qsos { build_minilog(pruned_qsos) };
+// build minilogs for each band and call; the pruned QSOs are a subset of the rows of each
+  timer.restart();
 
-  vector<future<unordered_set<string>>> futures;
-  vector<unordered_set<string>>         out_calls;
+  vector<call_id_set> out_calls;
 
-  for (const HF_BAND this_band : vector { HF_BAND::B160, HF_BAND::B80, HF_BAND::B40, HF_BAND::B20, HF_BAND::B15, HF_BAND::B10 } )
-//  for (const HF_BAND this_band : vector { HF_BAND::B160 } )
-    if (pruned_per_band_qsos.contains(this_band) and all_per_band_qsos.contains(this_band))                         // not every contest permits every band
-      futures.emplace_back(async(std::launch::async, process_band, ref(pruned_per_band_qsos.at(this_band)), ref(all_per_band_qsos.at(this_band)), ref(calls_with_no_freq_info), 
-                                                                   ref(calls_with_poor_freq_info), max_rel_mins));
-  
-  for (int n { 0 }; n < ssize(futures); ++n)
-    out_calls += move(futures[n].get());
+  if (MEMORY_BUDGET)                                    // hold only one band in memory at once
+    out_calls = process_bands_from_spill(all_qsos, scp_calls, calls_with_no_freq_info, calls_with_poor_freq_info, max_rel_mins, calls, dirname, timer, pool);
+  else
+  { const unordered_map<HF_BAND, band_log> all_per_band_qsos { build_minilog(all_qsos, max_rel_mins, calls, calls_with_no_freq_info, calls_with_poor_freq_info) };
+
+    timer.record(dirname, ""s, "build_minilog"s, n_qsos);
+
+    vector<future<call_id_set>> futures;
+
+    for (const HF_BAND this_band : vector { HF_BAND::B160, HF_BAND::B80, HF_BAND::B40, HF_BAND::B20, HF_BAND::B15, HF_BAND::B10 } )
+      if (all_per_band_qsos.contains(this_band) and has_pruned_qsos(all_per_band_qsos.at(this_band), scp_calls))     // not every contest permits every band
+        futures += pool.submit( [&, this_band] (void) { return process_band(all_per_band_qsos.at(this_band), scp_calls, calls_with_no_freq_info,
+                                                                            calls_with_poor_freq_info, max_rel_mins, calls, dirname, pool); } );
 
-  unordered_set<string> returned_calls;
+    FOR_ALL(futures, [&out_calls, &pool] (future<call_id_set>& fut) { out_calls += pool.wait(fut); });
+  }
+
+  timer.restart();
 
-  FOR_ALL(out_calls, [&returned_calls] (const auto& band_calls) { returned_calls += move(band_calls); });
+  call_id_set returned_calls;
+
+  FOR_ALL(out_calls, [&returned_calls] (const auto& band_calls) { returned_calls += band_calls; });
 
   if (verbose)
     cout << "total number of SCP calls = " << returned_calls.size() << endl;
 
   if (tracing)
-    cout << "call " << traced_call << " IS " << (returned_calls.contains(traced_call) ? "" : "NOT ") << "in initial SCP list" << endl;
+    cout << "call " << traced_call << " IS " << (returned_calls.contains(calls.find(traced_call)) ? "" : "NOT ") << "in initial SCP list" << endl;
   
   if (verbose)
     cout << "Finished processing directory: " << dirname << endl;
   
-// fill the output map
-  CALL_MAP rv(compare_calls);   // start with the map from tcalls
-  
-  rv += scp_cm;   // start with the map from tcalls
+// fill the output map with the rcalls that are tcalls, and those returned from the bands; only now do we need the calls themselves
+  vector<pair<string, int>> calls_and_counts;
 
-  for (auto& [ tcall, qsos ] : all_qsos)
-  { for (auto& qso : qsos)
-    { if (returned_calls.contains(qso.rcall()))
-        rv += qso.rcall();
-    }
-  }
+  for (CALL_ID id { 0 }; id < call_counts.size(); ++id)
+    if (call_counts[id] and (scp_calls.contains(id) or returned_calls.contains(id)))
+      calls_and_counts.emplace_back(calls.call(id), call_counts[id]);
+
+  const collated_calls rv { calls_and_counts };
+
+  if (caching and !write_call_map_cache(call_map_filename, calls_key, rv))
+    cerr << "WARNING: unable to write cache file: " << call_map_filename << endl;
+
+  timer.record(dirname, ""s, "output"s, n_qsos);
+  record_directory(n_qsos);
     
   return rv;
 }
@@ -921,72 +1822,129 @@ CALL_MAP process_directory(const contest_parameters& cp)
 /*! \brief                              Return the calls whose logged frequencies seem to be unreliable
     \param  all_qsos                    all the QSOs, per entrant's call
     \param  calls_with_no_freq_info     entrants whose logged frequency information is useless
+    \param  n_calls                     number of calls in the table in which the calls are interned
+    \param  pool                        pool on which to process the bands
+    \param  timer                       timer of the stage, which is charged for the work on each thread
     \return                             calls of stations whose logged frequency appears unreliable
-*/
-unordered_set<string> calls_with_unreliable_freq(const unordered_map<string /* tcall */, vector<small_qso>>& all_qsos, const unordered_set<string>& calls_with_no_freq_info)    //;                // all QSOs as recorded in the logs
-{ unordered_set<string> rv;
 
-  using BAND_TIME_FREQ = tuple<HF_BAND, int, int>;
-  
-  unordered_map<string /* tcall */, unordered_map<string /* rcall */, vector<BAND_TIME_FREQ>>> worked; 
+    A QSO between two entrants, neither of which is in <i>calls_with_no_freq_info</i>, is confirmed by each QSO
+    in the other entrant's log with the first entrant on the same band within RUN_TIME_RANGE minutes; a confirmation
+    is good if the frequencies are within FREQ_SKEW kHz. An entrant's frequency information is unreliable if fewer
+    than 90% of the confirmations of its QSOs are good.
 
-  for (const auto& [ tcall, qsos ] : all_qsos)
-  { if (!calls_with_no_freq_info.contains(tcall))           // neither tcall nor rcall may be a call with no frequency info
-    { unordered_map<string /* rcall */, vector<BAND_TIME_FREQ>> worked_by_this_tcall;
-  
-      for (const auto& qso : qsos)
-      { const string& rcall { qso.rcall() };
-      
-        if (!calls_with_no_freq_info.contains(rcall))               // neither tcall nor rcall may be a call with no frequency info
-          if (all_qsos.find(rcall) != all_qsos.cend())              // rcall is a tcall in the map
-            worked_by_this_tcall[rcall] += BAND_TIME_FREQ { band_from_qrg(qso.qrg()), qso.rel_mins(), qso.qrg() };
+    The QSOs between entrants are joined band by band: each band's QSOs are sorted by pair of calls and then by time,
+    so that the confirmations of each QSO lie in a window that moves forward through the other entrant's QSOs.
+*/
+call_id_set calls_with_unreliable_freq(const unordered_map<CALL_ID /* tcall */, vector<small_qso>>& all_qsos, const call_id_set& calls_with_no_freq_info,
+                                       const size_t n_calls, thread_pool& pool, stage_timer& timer)
+{ struct contact                // a QSO between two entrants
+  { CALL_ID lo;                 // the two calls, in order of identifier
+    CALL_ID hi;
+    bool    from_hi;            // whether the QSO is in the log of hi
+    int     rel_mins;
+    int     qrg;
+  };
+
+  using TOTAL_GOOD = pair<vector<int>, vector<int>>;    // numbers of confirmations, and of good confirmations, indexed by call identifier
+
+// gather the QSOs between entrants with frequency information, per band
+  array<vector<contact>, static_cast<size_t>(HF_BAND::BAD)> contacts_per_band;
+
+  timer.charge( [&] (void)
+    { for (const auto& [ tcall, qsos ] : all_qsos)
+      { if (!calls_with_no_freq_info.contains(tcall))       // neither tcall nor rcall may be a call with no frequency info
+        { for (const auto& qso : qsos)
+          { const CALL_ID rcall { qso.rcall() };
+
+            if (!calls_with_no_freq_info.contains(rcall) and all_qsos.contains(rcall))  // rcall is another entrant with frequency info
+              contacts_per_band[static_cast<size_t>(qso.band())] += contact { min(tcall, rcall), max(tcall, rcall), (tcall > rcall), qso.rel_mins(), qso.qrg() };
+          }
+        }
       }
-    
-      worked[tcall] = move(worked_by_this_tcall);
-    }
-  }
+    } );
 
-// all logged QSOs between entrants are now cross-indexed
-  using TOTAL_GOOD = pair<int, int>;                /* keep count of total and good QSOs */
-  
-  unordered_map<string /* tcall */, TOTAL_GOOD> accumulated_counts;
-  
-  for (const auto& [ tcall, rcall_map ] : worked)   // rcall_map is: unordered_map<string /* rcall */, vector<BAND_TIME_FREQ>
-  { int total { 0 };
-    int good  { 0 };
-    
-    for (const auto& [ rcall, btf_vec ] : rcall_map)
-    { for (const auto [ tband, ttime, tfreq ] : btf_vec)        // tcall, rcall, time and freq are now all accessible; look for the reverse QSO
-      { const auto& rcall_worked { worked.at(rcall) };            // rcall_worked is: unordered_map<string /* rcall */, vector<BAND_TIME_FREQ>>
-        
-        auto it { rcall_worked.find(tcall) };
-        
-        if (it != rcall_worked.cend())              // found the tcall QSOs in the rcall data
-        { const auto& [ call, vtf ] { *it };
-
-          for (const auto [ rband, rtime, rfreq ] : vtf)
-          { if ( (tband == rband) and (abs(ttime - rtime) < RUN_TIME_RANGE) )           // within five minutes on the right band
-            { total++;
-            
-              if (abs(tfreq - rfreq) < FREQ_SKEW)                               // within 2 kHz
-                good++;
+// join each band's QSOs with themselves; each confirmation counts for both calls
+  auto join_band = [n_calls] (vector<contact>& contacts)
+    { TOTAL_GOOD rv { vector<int>(n_calls, 0), vector<int>(n_calls, 0) };
+
+      auto& [ total, good ] { rv };
+
+      SORT(contacts, [] (const contact& c1, const contact& c2) { return (tie(c1.lo, c1.hi, c1.from_hi, c1.rel_mins) < tie(c2.lo, c2.hi, c2.from_hi, c2.rel_mins)); });
+
+      for (size_t first { 0 }; first < contacts.size(); )
+      { const CALL_ID lo { contacts[first].lo };
+        const CALL_ID hi { contacts[first].hi };
+
+        size_t middle { first };                            // the first QSO in the log of hi
+
+        while ( (middle < contacts.size()) and (contacts[middle].lo == lo) and (contacts[middle].hi == hi) and !contacts[middle].from_hi )
+          middle++;
+
+        size_t last { middle };                             // one past the last QSO between lo and hi
+
+        while ( (last < contacts.size()) and (contacts[last].lo == lo) and (contacts[last].hi == hi) )
+          last++;
+
+// both halves are chronological, so the window of confirmations only ever moves forward
+        size_t window_start { middle };
+        size_t window_end   { middle };
+
+        for (size_t n { first }; n < middle; ++n)
+        { const contact& c { contacts[n] };
+
+          while ( (window_start < last) and (contacts[window_start].rel_mins <= c.rel_mins - RUN_TIME_RANGE) )
+            window_start++;
+
+          window_end = max(window_end, window_start);
+
+          while ( (window_end < last) and (contacts[window_end].rel_mins < c.rel_mins + RUN_TIME_RANGE) )
+            window_end++;
+
+          for (size_t w { window_start }; w < window_end; ++w)
+          { total[lo]++;
+            total[hi]++;
+
+            if (abs(c.qrg - contacts[w].qrg) < FREQ_SKEW)       // within 2 kHz
+            { good[lo]++;
+              good[hi]++;
             }
           }
         }
+
+        first = last;
       }
-    }
-    
-    accumulated_counts[tcall] = { total, good };
+
+      return rv;
+    };
+
+  vector<future<TOTAL_GOOD>> futures;
+
+  for (auto& contacts : contacts_per_band)
+    if (!contacts.empty())
+      futures += pool.submit( [&contacts, &join_band, &timer] (void) { return timer.charge( [&contacts, &join_band] (void) { return join_band(contacts); } ); } );
+
+  vector<int> total(n_calls, 0);
+  vector<int> good(n_calls, 0);
+
+  for (auto& fut : futures)
+  { const TOTAL_GOOD band_counts { pool.wait(fut) };
+
+    timer.charge( [&] (void)
+      { for (size_t id { 0 }; id < n_calls; ++id)
+        { total[id] += band_counts.first[id];
+          good[id] += band_counts.second[id];
+        }
+      } );
   }
 
-  for (auto& [ tcall, total_good ] : accumulated_counts)
-  { const auto [ total, good ] { total_good };
-    
-    if (total != 0)
-    { const float good_fraction { float(good) / total };
+  call_id_set rv;
+
+  for (CALL_ID id { 0 }; id < n_calls; ++id)
+  { if (total[id] != 0)
+    { const float good_fraction { float(good[id]) / total[id] };
     
       if (good_fraction < 0.9)                      // 0.9 is arbitrary, but seems reasonable for defining unreliable logging of frequency 
-        rv += tcall;
+        rv += id;
     }
   }
 
@@ -997,82 +1955,302 @@ unordered_set<string> calls_with_unreliable_freq(const unordered_map<string /* t
     \param  qrg     frequency, in kHz
     \return         the band in which the frequency <i>qrg</i> lies
     
-    Throws an exception if <i>qrg</i> does not appear to be in a contest band
+    Returns HF_BAND::BAD if <i>qrg</i> does not appear to be in a contest band
 */
-HF_BAND band_from_qrg(const int qrg)
-{ if ((qrg >= 1800) and (qrg <= 2000))
-    return HF_BAND::B160;
-      
-  if ((qrg >= 3500) and (qrg <= 4000))
-    return HF_BAND::B80;
-      
-  if ((qrg >= 7000) and (qrg <= 7300))
-    return HF_BAND::B40;    
-
-  if ((qrg >= 14000) and (qrg <= 14350))
-    return HF_BAND::B20;
-
-  if ((qrg >= 21000) and (qrg <= 21450))
-    return HF_BAND::B15;
-      
-  if ((qrg >= 28000) and (qrg <= 29700))
-    return HF_BAND::B10;
-      
-  throw exception();
+HF_BAND band_from_qrg(const int qrg) noexcept
+{ struct band_limits { HF_BAND band; int low; int high; };       // limits are inclusive, in kHz
+
+  constexpr band_limits BAD_LIMITS { HF_BAND::BAD, 1, 0 };        // matches no frequency
+
+// indexed by frequency in MHz; each MHz overlaps at most one band
+  constexpr array<band_limits, 30> limits_by_mhz { BAD_LIMITS,                                       // 0
+                                                   { HF_BAND::B160, 1800, 2000 },                    // 1
+                                                   { HF_BAND::B160, 1800, 2000 },                    // 2
+                                                   { HF_BAND::B80, 3500, 4000 },                     // 3
+                                                   { HF_BAND::B80, 3500, 4000 },                     // 4
+                                                   BAD_LIMITS, BAD_LIMITS,                           // 5, 6
+                                                   { HF_BAND::B40, 7000, 7300 },                     // 7
+                                                   BAD_LIMITS, BAD_LIMITS, BAD_LIMITS, BAD_LIMITS,   // 8 - 11
+                                                   BAD_LIMITS, BAD_LIMITS,                           // 12, 13
+                                                   { HF_BAND::B20, 14000, 14350 },                   // 14
+                                                   BAD_LIMITS, BAD_LIMITS, BAD_LIMITS, BAD_LIMITS,   // 15 - 18
+                                                   BAD_LIMITS, BAD_LIMITS,                           // 19, 20
+                                                   { HF_BAND::B15, 21000, 21450 },                   // 21
+                                                   BAD_LIMITS, BAD_LIMITS, BAD_LIMITS, BAD_LIMITS,   // 22 - 25
+                                                   BAD_LIMITS, BAD_LIMITS,                           // 26, 27
+                                                   { HF_BAND::B10, 28000, 29700 },                   // 28
+                                                   { HF_BAND::B10, 28000, 29700 }                    // 29
+                                                 };
+
+  const unsigned int mhz { static_cast<unsigned int>(qrg) / 1000 };      // negative frequencies become very large
+
+  if (mhz >= limits_by_mhz.size())
+    return HF_BAND::BAD;
+
+  const band_limits& bl { limits_by_mhz[mhz] };
+
+  return ( ((qrg >= bl.low) and (qrg <= bl.high)) ? bl.band : HF_BAND::BAD );
 }
 
-/*! \brief                              Determine whether a station is running at a particular time and on a particular frequency
-    \param  call                        call of the target station
-    \param  rel_mins                    target relative minutes
-    \param  qrg                         target frequency, in kHz
-    \param  tcalls                      all the entrants
-    \param  calls_with_no_freq_info     entrants whose logged frequency information is useless
-    \param  calls_with_poor_freq_info   entrants whose logged frequency information is untrustworthy
-    \param  all_qsos_this_band          all the QSOs on this band, per entrant
-    \param  all_vec                     all the QSOs on this band
-    \param  all_time_map                map time to index in <i>all_vec</i>
-    \param  minimum_minutes             the global minimum number of minutes in the logs (typically zero)
-    \param  maximum_minutes             the global maximum number of minutes in the logs (typically 2879)
-    \param  ignore_call                 ignore this call in the logs (typically the call of the station that reported working <i>call</i> at this time and frequency)
-    \return                             whether <i>call</i> appears to have been running at time <i>time</i> on frequency <i>qrg</i>
+/*! \brief      Convert the start of a string to an integer
+    \param  sv  string to convert
+    \return     the integer at the start of <i>sv</i>
+
+    Behaves like from_string<int>(), without creating a stream: leading white space and a sign are permitted;
+    returns zero if <i>sv</i> does not start with an integer, and saturates values outside the range of an int
 */
-bool is_stn_running(const string& call, const int rel_mins, const int qrg, const unordered_set<string>& tcalls, const unordered_set<string>& calls_with_no_freq_info,
-                      const unordered_set<string>& calls_with_poor_freq_info, const unordered_map<string /* tcall */, vector<small_qso>>& all_qsos_this_band, const vector<small_qso>& all_vec,
-                      const vector<vector<small_qso>::const_iterator>& all_time_map, const int minimum_minutes, const int maximum_minutes,
-                      const string& ignore_call)
-{ if (!tcalls.contains(call))        // is it a valid entrant call?
-    return false;
+int leading_int(const string_view sv) noexcept
+{ size_t posn { sv.find_first_not_of(" \t\n\v\f\r"sv) };
 
-  const int target_minutes { rel_mins };
-  
-  if (call_has_good_freq_info(call, calls_with_no_freq_info, calls_with_poor_freq_info))            // call has good frequency info
-  { const auto [lb, ub] { get_bounds(target_minutes, minimum_minutes, maximum_minutes, CLOCK_SKEW, all_qsos_this_band.at(call)) };
-   
-    return ANY_OF(lb, ub, [qrg, &call] (const small_qso& qso) { return ( abs(qrg - qso.qrg()) <= FREQ_SKEW); });
+  if (posn == string_view::npos)
+    return 0;
+
+  const bool negative { sv[posn] == '-' };
+
+  if ( negative or (sv[posn] == '+') )
+    posn++;
+
+  uint64_t value;
+
+  const auto [ ptr, ec ] { from_chars(sv.data() + posn, sv.data() + sv.size(), value) };
+
+  if (ec == errc::invalid_argument)
+    return 0;
+
+  constexpr int64_t MAX_INT { numeric_limits<int>::max() };
+  constexpr int64_t MIN_INT { numeric_limits<int>::min() };
+
+  if (ec == errc::result_out_of_range)
+    return (negative ? MIN_INT : MAX_INT);
+
+  if (negative)
+    return ( (value > static_cast<uint64_t>(-MIN_INT)) ? MIN_INT : static_cast<int>(-static_cast<int64_t>(value)) );
+
+  return ( (value > static_cast<uint64_t>(MAX_INT)) ? MAX_INT : static_cast<int>(value) );
+}
+
+// -----------  qso_decoder  ----------------
+
+/*! \class  qso_decoder
+    \brief  State shared by all the QSOs read from a single log
+
+    Holds the call table, caches the day number of each distinct date, numbers the QSO lines,
+    counts the rejected lines and holds any messages about them.
+    Not thread safe; each log has its own decoder.
+*/
+
+/*! \brief          Convert the date and time fields of a QSO line to a time
+    \param  dat     date field, YYYY-MM-DD
+    \param  utc     time field, HHMM
+    \return         the time represented by <i>dat</i> and <i>utc</i>
+
+    Out-of-range values are normalised in the same way as by timegm()
+*/
+time_t qso_decoder::time(const string_view dat, const string_view utc)
+{ auto safe_substr = [] (const string_view sv, const size_t start_posn, const size_t length)
+    { return ( (sv.size() > start_posn) ? sv.substr(start_posn, length) : string_view { } ); };
+
+// days since 1970-01-01 of a (proleptic Gregorian) date; from http://howardhinnant.github.io/date_algorithms.html
+  auto days_from_civil = [] (int64_t y, const int64_t m, const int64_t d)
+    { y -= (m <= 2);
+
+      const int64_t era { (y >= 0 ? y : y - 399) / 400 };
+      const int64_t yoe { y - era * 400 };                                       // [0, 399]
+      const int64_t doy { (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1 };     // [0, 365]
+      const int64_t doe { yoe * 365 + yoe / 4 - yoe / 100 + doy };               // [0, 146096]
+
+      return era * 146097 + doe - 719468;
+    };
+
+  int64_t days;
+
+  if (const auto it { FIND_IF(_date_cache, [dat] (const auto& pr) { return (pr.first == dat); }) }; it != _date_cache.end())
+    days = it->second;
+  else
+  { const int64_t year  { leading_int(safe_substr(dat, 0, 4)) };
+    const int64_t month { leading_int(safe_substr(dat, 5, 2)) - 1 };                      // zero-based, and possibly out of range
+    const int64_t mday  { leading_int(safe_substr(dat, 8, 2)) };
+    const int64_t years { (month >= 0) ? (month / 12) : ((month - 11) / 12) };            // normalise the month
+    
+    days = days_from_civil(year + years, month - years * 12 + 1, 1) + mday - 1;
+
+    if (_date_cache.size() < MAX_CACHED_DATES)
+      _date_cache.emplace_back(string { dat }, days);
   }
 
-// can't trust call's frequency information; does someone else say that they have worked him here?
-  const int lower_target_minutes { max(target_minutes - CLOCK_SKEW, minimum_minutes) };
-  const int upper_target_minutes { min(target_minutes + CLOCK_SKEW, maximum_minutes) };
-  
-  return ANY_OF(all_time_map.at(lower_target_minutes), all_time_map.at(upper_target_minutes + 1),
-                 [qrg, &call, &ignore_call] (const small_qso& qso) { return (qso.tcall() != ignore_call) and (qso.rcall() == call) and (abs(qrg - qso.qrg()) <= FREQ_SKEW); });
+  const int64_t hour   { leading_int(safe_substr(utc, 0, 2)) };
+  const int64_t minute { leading_int(safe_substr(utc, 2, 2)) };
+
+  return static_cast<time_t>(days * 86400 + hour * 3600 + minute * 60);
+}
+
+// -----------  parsed_log  ----------------
+
+/*! \class  parsed_log
+    \brief  The valid QSOs read from a single log, with their own call table
+
+    Logs are parsed independently of one another, and then merged into the contest in the order of
+    their files; so the calls are interned, and the QSO lines numbered, relative to the log.
+*/
+
+/*! \brief              Constructor
+    \param  filename    name of the file that contains the log
+    \param  t_start     time of the start of the contest
+    \param  t_end       one second past the end of the contest
+*/
+parsed_log::parsed_log(const string& filename, const time_t t_start, const time_t t_end)
+{ qso_decoder         decoder { _calls, t_start, t_end };      // converts fields to QSOs, and counts the rejected lines
+  vector<string_view> fields;                                   // fields of a QSO line; reused for every line
+
+  memory_mapped_file logfile { filename };                      // the QSO lines are tokenised in place in the mapping
+
+  for_all_qso_lines(logfile.contents(), fields, [this, &decoder] (const vector<string_view>& qso_fields)
+    { small_qso qso { qso_fields, decoder };                    // the calls are checked for legality, and interned, here
+
+      if (qso.valid())                                          // if we successfully constructed a valid QSO within the contest period
+        _qsos += move(qso);
+    });
+
+  _n_qso_lines = decoder.n_qso_lines();
+
+  for (size_t n { 0 }; n < _rejects.size(); ++n)
+    _rejects[n] = decoder.rejects(static_cast<QSO_REJECT>(n));
+
+  _bad_qsos = decoder.bad_qsos().str();
+}
+
+// -----------  contest_logs  ----------------
+
+/*! \class  contest_logs
+    \brief  The valid QSOs read from all the logs in a contest directory
+
+    The QSOs of each log are divided into groups by tcall. The groups are held in the order in which a serial
+    reading of the logs would encounter them: log by log, in the order of the files. Nothing here depends on
+    any parameter other than the contest period, so a contest_logs may be cached (see log_cache.h).
+    QSO identifiers are relative to the first QSO line in the directory.
+*/
+
+/*! \brief              Constructor
+    \param  filenames   names of the files that contain the logs
+    \param  t_start     time of the start of the contest
+    \param  t_end       one second past the end of the contest
+    \param  pool        pool on which to parse the logs
+    \param  timer       timer of the stage, which is charged for the parsing and merging
+
+    The logs are parsed in parallel, and merged in the order of <i>filenames</i>.
+    Any messages about rejected lines are displayed on cerr, in the same order.
+*/
+contest_logs::contest_logs(const vector<string>& filenames, const time_t t_start, const time_t t_end, thread_pool& pool, stage_timer& timer)
+{ vector<future<parsed_log>> parsed_logs;
+
+  FOR_ALL(filenames, [&parsed_logs, &pool, &timer, t_start, t_end] (const string& filename)
+    { parsed_logs += pool.submit( [&filename, &timer, t_start, t_end] (void) { return timer.charge( [&] (void) { return parsed_log { filename, t_start, t_end }; } ); } ); });
+
+  for (size_t n { 0 }; n < filenames.size(); ++n)
+    timer.charge( [this, n, log = pool.wait(parsed_logs[n])] (void) mutable { add_log(n, move(log)); } );   // the wait is not charged
+}
+
+/*! \brief          Add the QSOs of a log
+    \param  n       index of the log in the directory
+    \param  log     the parsed log
+*/
+void contest_logs::add_log(const size_t n, parsed_log&& log)
+{ cerr << log.bad_qsos();
+
+  for (size_t r { 0 }; r < _rejects.size(); ++r)
+    _rejects[r] += log.rejects()[r];
+
+  const int id_base { _n_qso_lines };
+
+  _n_qso_lines += log.n_qso_lines();
+
+  vector<CALL_ID> call_ids;                                             // identifier in _calls of each call in the log's table
+
+  call_ids.reserve(log.calls().size());
+
+  for (CALL_ID id { 0 }; id < log.calls().size(); ++id)               // the log's identifiers are in order of first appearance in the log
+    call_ids += _calls.id(log.calls().call(id));
+
+  unordered_map<CALL_ID /* tcall */, vector<small_qso>> tcall_qsos;    // do not assume that the tcall doesn't change within the log
+
+  for (small_qso& qso : move(log).qsos())
+  { qso.rebase(call_ids, id_base);
+    tcall_qsos[qso.tcall()] += move(qso);
+  }
+
+  for (const auto& [ tcall, qsos ] : tcall_qsos)
+    add_group(static_cast<uint32_t>(n), tcall, qsos);
+}
+
+/*! \brief              Append a group of QSOs
+    \param  log_index   index of the log file that contains the QSOs
+    \param  tcall       the tcall of all the QSOs
+    \param  qsos        the QSOs, in the order of the lines in the log
+*/
+void contest_logs::add_group(const uint32_t log_index, const CALL_ID tcall, const vector<small_qso>& qsos)
+{ _group_log += log_index;
+  _group_tcall += tcall;
+  _qsos += qsos;
+  _group_end += static_cast<uint32_t>(_qsos.size());
+}
+
+/// release the QSOs and the groups, keeping the calls, the number of QSO lines and the rejects
+void contest_logs::release_qsos(void)
+{ _group_log = vector<uint32_t> { };
+  _group_tcall = vector<CALL_ID> { };
+  _group_end = vector<uint32_t> { };
+  _qsos = vector<small_qso> { };
+}
+
+/*! \brief              Obtain the logs for a contest, from the cache if possible
+    \param  cp          directory, start and duration
+    \param  filenames   names of the files in the directory
+    \param  key         key that identifies the inputs (see log_cache_key()); ignored if there is no cache
+    \param  pool        pool on which to parse the logs, if necessary
+    \param  timer       timer of the stage, which is charged for the parsing and for reading and writing the cache
+    \return             the QSOs in the logs in <i>cp.directory()</i>
+
+    The cache is used only if the -cache option is present. With -i, the logs are always parsed (so that
+    the bad lines are displayed), and the cache is refreshed.
+*/
+contest_logs read_logs(const contest_parameters& cp, const vector<string>& filenames, const string& key, thread_pool& pool, stage_timer& timer)
+{ if (CACHE_DIRECTORY.empty())
+    return contest_logs { filenames, cp.t_start(), cp.t_end(), pool, timer };
+
+  const string cache_filename { log_cache_filename(CACHE_DIRECTORY, cp.directory()) };
+
+  if (!DISPLAY_BAD_QSOS)
+  { if (optional<contest_logs> cached_logs { timer.charge( [&cache_filename, &key] (void) { return read_log_cache(cache_filename, key); } ) }; cached_logs)
+    { if (verbose)
+        cout << cp.directory() << ": read logs from cache file: " << cache_filename << endl;
+
+      return move(*cached_logs);
+    }
+  }
+
+  contest_logs rv { filenames, cp.t_start(), cp.t_end(), pool, timer };
+
+  if (!timer.charge( [&cache_filename, &key, &rv] (void) { return write_log_cache(cache_filename, key, rv); } ))
+    cerr << "WARNING: unable to write cache file: " << cache_filename << endl;
+
+  return rv;
 }
 
-/*! \brief                      Return lower and upper bounds for a time range in a vector<small_qso>
+/*! \brief                      Return lower and upper bounds for a time range in a chronologically-ordered set of rows
     \param  target_minutes      the target time
     \param  minimum_minutes     minimum time in a contest (usually 0)
     \param  maximum_minutes     maximum time in a contest (usually 1439 or 2879)
     \param  ALLOWED_SKEW        maximum permitted skew time, in minutes
-    \param  vec                 chronologically-ordered target vector of small_qso elements
+    \param  rows                chronologically-ordered rows of <i>bl</i>
+    \param  bl                  the log to which <i>rows</i> refer
     \return                     iterators to the lower bound and upper bound of the range, taking CLOCK_SKEW into account
 */
-pair<vector<small_qso>::const_iterator, vector<small_qso>::const_iterator> get_bounds(const int target_minutes, const int minimum_minutes, const int maximum_minutes,
-                                                                                      const int ALLOWED_SKEW, const vector<small_qso>& vec)
+pair<span<const uint32_t>::iterator, span<const uint32_t>::iterator> get_bounds(const int target_minutes, const int minimum_minutes, const int maximum_minutes,
+                                                                                const int ALLOWED_SKEW, span<const uint32_t> rows, const band_log& bl)
 { const int  lower_target_minutes { max(target_minutes - ALLOWED_SKEW, minimum_minutes) };
   const int  upper_target_minutes { min(target_minutes + ALLOWED_SKEW, maximum_minutes) };
-  const auto lb                   { lower_bound(vec.cbegin(), vec.cend(), lower_target_minutes, [] (const auto& element, const auto& target) { return (element.rel_mins() < target); }) };
-  const auto ub                   { upper_bound(lb, vec.cend(), upper_target_minutes, [] (const auto& target, const auto& element) { return (target < element.rel_mins()); }) }; 
+  const auto lb                   { lower_bound(rows.begin(), rows.end(), lower_target_minutes, [&bl] (const uint32_t row, const int target) { return (bl.rel_mins(row) < target); }) };
+  const auto ub                   { upper_bound(lb, rows.end(), upper_target_minutes, [&bl] (const int target, const uint32_t row) { return (target < bl.rel_mins(row)); }) }; 
   
   return pair { lb, ub };
 }
@@ -0,0 +1,276 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   drscp_bench.cpp
+
+    Program to benchmark the stages of drscp on the logs of a contest
+
+    drscp_bench -dir <directory of contest logs> [-start <start date/time>] [-hrs <duration in hours>] [-n iterations] [-j number-of-threads]
+
+      -start        date/time of the start of the contest: YYYY-MM-DD[THH[:MM[:SS]]]. Default 2022-10-29
+      -hrs          duration of the contest, in hours. Default 24
+      -n <n>        the number of times that each benchmark is run. Default 5
+      -j <n>        the number of threads in the pool. Default: the number of hardware threads.
+
+    Each benchmark is run the given number of times; the best and the median elapsed times are reported, together with
+    the best time per item. The micro-benchmarks run on a single thread, on the QSOs of the band with the most QSOs;
+    the ingestion, unreliable_freq and process_directory benchmarks use the pool. The containing benchmarks
+    query binary XSCP files of the calls of the contest, with and without the substring index.
+
+    The logs are typically generated by drscp_gen; "make bench" generates a standard set and runs this program on it.
+*/
+
+#include "bust.h"
+#include "call_table.h"
+#include "command_line.h"
+#include "diskfile.h"
+#include "drscp.h"
+#include "macros.h"
+#include "scp_file.h"
+#include "stats.h"
+#include "string_functions.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+
+extern int            TL_LIMIT;             // defined in drscp.cpp
+extern stats_recorder STATISTICS;           // defined in drscp.cpp
+
+constexpr int    CLOCK_SKEW      { 2 };     ///< maximum permitted clock skew when comparing logs, in minutes, as in drscp.cpp
+constexpr size_t MAX_BUST_CALLS  { 2000 };  ///< maximum number of calls whose every pair is tested by the is_bust benchmarks
+constexpr size_t MAX_FRAGMENTS   { 2000 };  ///< maximum number of strings for which the containing benchmarks query
+
+volatile size_t sink { 0 };                 ///< receives a result of each benchmark, so that the work is not optimised away
+
+/*! \brief                  Run a benchmark and report its timings
+    \param  name            name of the benchmark
+    \param  n_iterations    number of times to run <i>f</i>
+    \param  n_items         number of items processed by each run of <i>f</i>
+    \param  f               function to benchmark, which returns a value that depends on its work
+    \return                 the best elapsed time, in seconds
+*/
+template <typename F>
+double benchmark(const string& name, const int n_iterations, const int64_t n_items, F&& f)
+{ vector<double> secs;
+
+  for (int n { 0 }; n < n_iterations; ++n)
+  { const auto start { steady_clock::now() };
+
+    sink = sink + static_cast<size_t>(f());
+    secs += duration<double>(steady_clock::now() - start).count();
+  }
+
+  SORT(secs);
+
+  cout << left << setw(22) << name << right << setw(12) << n_items
+       << fixed << setprecision(3) << setw(12) << secs.front() * 1e3 << setw(12) << secs[secs.size() / 2] * 1e3
+       << setprecision(1) << setw(12) << (n_items ? (secs.front() * 1e9 / n_items) : 0.0) << endl;
+
+  return secs.front();
+}
+
+int main(int argc, char** argv)
+{ const command_line cl(argc, argv);
+
+  if (!cl.value_present("-dir"s))
+  { cerr << "ERROR: no directory given" << endl;
+    return -1;
+  }
+
+  const string start        { cl.value_present("-start"s) ? cl.value("-start"s) : "2022-10-29"s };
+  const string hours        { cl.value_present("-hrs"s) ? cl.value("-hrs"s) : "24"s };
+  const int    n_iterations { cl.value_present("-n"s) ? max(1, from_string<int>(cl.value("-n"s))) : 5 };
+  const int    n_threads    { cl.value_present("-j"s) ? from_string<int>(cl.value("-j"s)) : 0 };
+
+  const contest_parameters cp { cl.value("-dir"s) + " "s + start + " "s + hours };
+
+  thread_pool pool { (n_threads > 0) ? static_cast<unsigned int>(n_threads) : thread::hardware_concurrency() };
+  stage_timer timer { STATISTICS };         // STATISTICS is disabled, so nothing is recorded
+
+  const vector<string> filenames    { files_in_directory(cp.directory(), LINKS::INCLUDE) };
+  const int            max_rel_mins { cp.hours() * 60 - 1 };
+
+  cout << "directory: " << cp.directory() << "; logs: " << filenames.size() << "; threads: " << pool.size() << "; iterations: " << n_iterations << endl << endl;
+
+  cout << left << setw(22) << "benchmark" << right << setw(12) << "items" << setw(12) << "best ms" << setw(12) << "median ms" << setw(12) << "ns/item" << endl;
+
+// the fixtures: the QSOs of the contest, prepared as process_directory prepares them
+  const contest_logs logs { read_logs(cp, filenames, ""s, pool, timer) };
+  const call_table&  calls { logs.calls() };
+
+  benchmark("ingestion"s, n_iterations, logs.n_qso_lines(), [&] (void) { return read_logs(cp, filenames, ""s, pool, timer).qsos().size(); });
+
+  unordered_map<CALL_ID /* tcall */, vector<small_qso>> all_qsos;
+  call_id_set                                           scp_calls;
+
+  for (size_t g { 0 }; g < logs.n_groups(); ++g)
+  { if (ssize(logs.group_qsos(g)) >= TL_LIMIT)
+      scp_calls += logs.group_tcall(g);
+
+    all_qsos.try_emplace(logs.group_tcall(g), logs.group_qsos(g).begin(), logs.group_qsos(g).end());
+  }
+
+  for (auto& [ tcall, qsos ] : all_qsos)
+    SORT(qsos);
+
+  call_id_set calls_with_no_freq_info;
+
+  for (const auto& [ tcall, qsos ] : all_qsos)
+  { static const set<int> default_band_freq { 1800, 3500, 7000, 14000, 21000, 28000 };
+
+    if (ALL_OF(qsos, [] (const small_qso& qso) { return default_band_freq.contains(qso.qrg()); }))
+      calls_with_no_freq_info += tcall;
+  }
+
+  const int64_t n_qsos { accumulate(all_qsos.cbegin(), all_qsos.cend(), int64_t { 0 }, [] (const int64_t n, const auto& pr) { return n + ssize(pr.second); }) };
+
+  const call_id_set calls_with_poor_freq_info { calls_with_unreliable_freq(all_qsos, calls_with_no_freq_info, calls.size(), pool, timer) };
+
+  benchmark("unreliable_freq"s, n_iterations, n_qsos, [&] (void) { return calls_with_unreliable_freq(all_qsos, calls_with_no_freq_info, calls.size(), pool, timer).size(); });
+
+// band_log replaced the time map, so its construction is the corresponding benchmark
+  const unordered_map<HF_BAND, band_log> per_band_qsos { build_minilog(all_qsos, max_rel_mins, calls, calls_with_no_freq_info, calls_with_poor_freq_info) };
+
+  benchmark("build_minilog"s, n_iterations, n_qsos, [&] (void) { return build_minilog(all_qsos, max_rel_mins, calls, calls_with_no_freq_info, calls_with_poor_freq_info).size(); });
+
+  if (per_band_qsos.empty())
+  { cerr << "ERROR: no QSOs" << endl;
+    return -1;
+  }
+
+  const band_log& bl { max_element(per_band_qsos.cbegin(), per_band_qsos.cend(), [] (const auto& pr1, const auto& pr2) { return (pr1.second.size() < pr2.second.size()); })->second };
+
+// the pairs of calls tested by the is_bust benchmarks
+  const size_t        n_bust_calls { min(MAX_BUST_CALLS, calls.size()) };
+  const int64_t       n_pairs      { static_cast<int64_t>(n_bust_calls * (n_bust_calls - 1) / 2) };
+  vector<packed_call> packed_calls;
+
+  for (CALL_ID id { 0 }; id < n_bust_calls; ++id)
+    packed_calls.emplace_back(calls.call(id));
+
+  benchmark("is_bust(string_view)"s, n_iterations, n_pairs, [&] (void) { size_t rv { 0 };
+
+                                                                          for (CALL_ID id1 { 0 }; id1 < n_bust_calls; ++id1)
+                                                                            for (CALL_ID id2 { id1 + 1 }; id2 < n_bust_calls; ++id2)
+                                                                              rv += (is_bust(calls.call(id1), calls.call(id2)) ? 1 : 0);
+
+                                                                          return rv;
+                                                                        });
+
+  benchmark("is_bust(packed_call)"s, n_iterations, n_pairs, [&] (void) { size_t rv { 0 };
+
+                                                                          for (size_t n1 { 0 }; n1 < packed_calls.size(); ++n1)
+                                                                            for (size_t n2 { n1 + 1 }; n2 < packed_calls.size(); ++n2)
+                                                                              rv += (is_bust(packed_calls[n1], packed_calls[n2]) ? 1 : 0);
+
+                                                                          return rv;
+                                                                        });
+
+  call_id_set rcalls;
+
+  for (uint32_t row { 0 }; row < bl.size(); ++row)
+    rcalls += bl.rcall(row);
+
+  benchmark("possible_busts"s, n_iterations, rcalls.size(), [&] (void) { return possible_busts(rcalls, calls).size(); });
+
+  benchmark("get_bounds"s, n_iterations, bl.size(), [&] (void) { size_t rv { 0 };
+
+                                                                 for (const CALL_ID tcall : bl.tcalls())
+                                                                 { const span<const uint32_t> rows { bl.tcall_rows(tcall) };
+
+                                                                   for (const uint32_t row : rows)
+                                                                   { const auto [ lb, ub ] { get_bounds(bl.rel_mins(row), 0, max_rel_mins, CLOCK_SKEW, rows, bl) };
+
+                                                                     rv += (ub - lb);
+                                                                   }
+                                                                 }
+
+                                                                 return rv;
+                                                               });
+
+// as in process_band, ask whether the entrant that was worked in each QSO was running at the time
+  vector<uint32_t> entrant_rows;
+
+  for (uint32_t row { 0 }; row < bl.size(); ++row)
+    if (bl.tcalls().contains(bl.rcall(row)))
+      entrant_rows += row;
+
+  benchmark("run_segments"s, n_iterations, bl.size(), [&] (void) { return run_segments { bl, max_rel_mins, calls.size(), calls_with_no_freq_info, calls_with_poor_freq_info, bl.tcalls() }.size(); });
+
+  const run_segments runs { bl, max_rel_mins, calls.size(), calls_with_no_freq_info, calls_with_poor_freq_info, bl.tcalls() };
+
+  benchmark("is_running"s, n_iterations, entrant_rows.size(), [&] (void) { size_t rv { 0 };
+
+                                                                           for (const uint32_t row : entrant_rows)
+                                                                             rv += (runs.is_running(bl.rcall(row), bl.rel_mins(row), bl.qrg(row), bl.tcall(row)) ? 1 : 0);
+
+                                                                           return rv;
+                                                                         });
+
+  benchmark("process_band"s, n_iterations, bl.size(), [&] (void) { return process_band(bl, scp_calls, calls_with_no_freq_info, calls_with_poor_freq_info,
+                                                                                       max_rel_mins, calls, cp.directory(), pool).size(); });
+
+// end to end
+  const double best_secs { benchmark("process_directory"s, n_iterations, logs.n_qso_lines(), [&] (void) { return process_directory(cp, pool).size(); }) };
+
+// partial-call queries, for three characters from the calls themselves, as typed into a logger
+  const collated_calls contest_calls   { process_directory(cp, pool) };
+  const string         xscp_base       { (filesystem::temp_directory_path() / ("drscp_bench-"s + to_string(getpid()))).string() };
+  const string         plain_filename  { xscp_base + ".bin"s };
+  const string         indexed_filename { xscp_base + "-index.bin"s };
+
+  { ofstream plain { plain_filename, ios::binary | ios::trunc };
+    ofstream indexed { indexed_filename, ios::binary | ios::trunc };
+
+    plain << binary_xscp(contest_calls, 0);
+    indexed << binary_xscp(contest_calls, 0, true);
+  }
+
+  { const binary_xscp_file plain { plain_filename };
+    const binary_xscp_file indexed { indexed_filename };
+
+    vector<string> fragments;
+
+    for (size_t n { 0 }; (n < indexed.size()) and (fragments.size() < MAX_FRAGMENTS); n += max(size_t { 1 }, indexed.size() / MAX_FRAGMENTS))
+      if (const string_view call { indexed.call(n) }; call.size() >= 3)
+        fragments += string { call.substr((call.size() > 3) ? 1 : 0, 3) };
+
+    auto query = [&fragments] (const binary_xscp_file& xscp, const XSCP_ORDER order)
+      { size_t rv { 0 };
+
+        for (const string& fragment : fragments)
+          rv += xscp.calls_containing(fragment, order).size();
+
+        return rv;
+      };
+
+    benchmark("containing(scan)"s,  n_iterations, fragments.size(), [&] (void) { return query(plain, XSCP_ORDER::CALLSIGN); });
+    benchmark("containing(index)"s, n_iterations, fragments.size(), [&] (void) { return query(indexed, XSCP_ORDER::CALLSIGN); });
+    benchmark("containing(count)"s, n_iterations, fragments.size(), [&] (void) { return query(indexed, XSCP_ORDER::COUNT); });
+  }
+
+  file_delete(plain_filename);
+  file_delete(indexed_filename);
+
+  cout << endl << "process_directory throughput: " << fixed << setprecision(0) << (logs.n_qso_lines() / best_secs) << " QSO lines per second" << endl;
+
+  return 0;
+}
@@ -0,0 +1,368 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   drscp_gen.cpp
+
+    Program to generate synthetic Cabrillo logs of a contest, for benchmarking drscp
+
+    drscp_gen -dir <output directory> [-start <start date/time>] [-hrs <duration in hours>] [-entrants n] [-others n]
+              [-rate n] [-run fraction] [-bust fraction] [-skew minutes] [-fskew kHz] [-nofreq fraction] [-seed n]
+
+      -dir <dir>        directory into which the logs are written; it is created if necessary
+      -start            date/time of the start of the contest: YYYY-MM-DD[THH:MM]. Default 2022-10-29
+      -hrs <n>          duration of the contest, in hours. Default 24
+      -entrants <n>     number of stations that submit a log. Default 500
+      -others <n>       number of stations that are worked but do not submit a log. Default 4000
+      -rate <n>         QSOs per hour of each entrant while active. Default 60
+      -run <f>          fraction of each entrant's operating time spent running rather than searching and pouncing. Default 0.5
+      -bust <f>         fraction of received calls that are miscopied. Default 0.02
+      -skew <n>         maximum error of an entrant's clock, in minutes; one entrant in five has an error. Default 1
+      -fskew <n>        maximum error of an entrant's logged frequency, in kHz; one entrant in ten has an error. Default 1
+      -nofreq <f>       fraction of entrants that log only the band edge instead of the frequency. Default 0.05
+      -seed <n>         seed of the random number generator. Default 1
+
+    The same parameters always generate the same logs. On success, the program writes to the standard output
+    a line suitable for a drscp list of contests: the directory, the start of the contest and its duration.
+
+    Each entrant operates in blocks of thirty minutes, on a random band, either running or searching and pouncing;
+    some blocks are spent off the air. A running entrant is called by stations that do not submit a log; a searching
+    entrant works stations that are running on the same band, and a QSO with a running entrant appears in both logs.
+    A few of the stations that do not submit a log run too; most are worked only a few times, so the calls that are
+    worked, including the busts, follow a realistic long-tailed distribution.
+*/
+
+#include "command_line.h"
+#include "macros.h"
+#include "string_functions.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+constexpr int N_BANDS        { 6 };     ///< number of HF contest bands
+constexpr int BLOCK_MINUTES { 30 };     ///< length of a block of operating time, in minutes
+
+constexpr array<int, N_BANDS>    BAND_EDGE   { 1800, 3500, 7000, 14000, 21000, 28000 };    ///< lowest frequency of each band, in kHz
+constexpr array<double, N_BANDS> BAND_WEIGHT { 0.05, 0.15, 0.25, 0.25, 0.15, 0.15 };         ///< relative activity on each band
+constexpr int                    BAND_WIDTH  { 80 };                                         ///< width of the portion of each band that is used, in kHz
+
+/// prefixes from which the calls are built
+static const vector<string> PREFIXES { "K"s, "W"s, "N"s, "AA"s, "KB"s, "WA"s, "VE"s, "XE"s, "PY"s, "LU"s, "DL"s, "G"s, "F"s, "I"s, "EA"s,
+                                       "OH"s, "SM"s, "OK"s, "SP"s, "HA"s, "YU"s, "UA"s, "UR"s, "JA"s, "BY"s, "VK"s, "ZL"s, "ZS"s, "4X"s, "9A"s };
+
+// -----------  station  ----------------
+
+/*! \class  station
+    \brief  A station that takes part in the synthetic contest
+*/
+
+class station
+{
+public:
+
+  string                   call;                        ///< call of the station
+  bool                     entrant      { false };      ///< whether the station submits a log
+  bool                     runner       { false };      ///< whether a station that does not submit a log runs
+  int                      zone         { 1 };          ///< the exchange sent by the station
+  int                      clock_skew   { 0 };          ///< error of the station's clock, in minutes
+  int                      freq_skew    { 0 };          ///< error of the station's logged frequency, in kHz
+  bool                     no_freq_info { false };      ///< whether the station logs the band edge instead of the frequency
+  array<int, N_BANDS>      run_qrg      { };            ///< the frequency on which the station runs, per band, in kHz
+  vector<pair<int, string>> log_lines   { };            ///< QSO lines of the log, with the logged minute of each
+};
+
+/*! \brief          Generate a random call
+    \param  rng     random number generator
+    \return         a random call, made of a prefix, a digit and a suffix of one to three letters, occasionally portable
+*/
+string random_call(mt19937_64& rng)
+{ uniform_int_distribution<size_t> prefix_dist  { 0, PREFIXES.size() - 1 };
+  uniform_int_distribution<int>    digit_dist   { 1, 9 };
+  uniform_int_distribution<int>    letter_dist  { 0, 25 };
+  const array<double, 3>           suffix_weight { 0.1, 0.4, 0.5 };
+  discrete_distribution<int>       suffix_dist  { suffix_weight.begin(), suffix_weight.end() };
+  uniform_real_distribution<>      portable_dist { 0, 1 };
+
+  string    rv            { PREFIXES[prefix_dist(rng)] + to_string(digit_dist(rng)) };
+  const int suffix_length { suffix_dist(rng) + 1 };
+
+  for (int n { 0 }; n < suffix_length; ++n)
+    rv += UPPER_CASE_LETTERS[letter_dist(rng)];
+
+  if (portable_dist(rng) < 0.02)
+    rv += "/"s + to_string(digit_dist(rng));
+
+  return rv;
+}
+
+/*! \brief          Is a string acceptable to drscp as a call?
+    \param  call    string to test
+    \return         whether <i>call</i> would be accepted as a call
+*/
+bool acceptable_call(const string& call)
+  { return (call.size() >= 3) and !contains(string { "/Q0" }, call[0]) and (call.back() != '/'); }
+
+/*! \brief          Miscopy a call
+    \param  call    the correct call
+    \param  rng     random number generator
+    \return         a plausible bust of <i>call</i>: a substitution, insertion, deletion or transposition
+*/
+string bust(const string& call, mt19937_64& rng)
+{ uniform_real_distribution<> kind_dist { 0, 1 };
+
+  for (int attempt { 0 }; attempt < 10; ++attempt)
+  { uniform_int_distribution<size_t> posn_dist { 0, call.size() - 1 };
+
+    const size_t posn { posn_dist(rng) };
+    const double kind { kind_dist(rng) };
+    const string& alphabet { isdigit(call[posn]) ? DIGITS : UPPER_CASE_LETTERS };
+
+    uniform_int_distribution<size_t> char_dist { 0, alphabet.size() - 1 };
+
+    string rv { call };
+
+    if (kind < 0.6)                                     // substitution
+      rv[posn] = alphabet[char_dist(rng)];
+    else if (kind < 0.75)                               // insertion
+      rv.insert(posn, 1, alphabet[char_dist(rng)]);
+    else if (kind < 0.9)                                // deletion
+      rv.erase(posn, 1);
+    else if (posn + 1 < rv.size())                      // transposition
+      swap(rv[posn], rv[posn + 1]);
+
+    if ( (rv != call) and acceptable_call(rv) )
+      return rv;
+  }
+
+  return call;
+}
+
+/*! \brief          Obtain a value from the command line
+    \param  cl      the command line
+    \param  name    name of the parameter
+    \param  dflt    value if the parameter is absent
+    \return         the value of <i>name</i>, or <i>dflt</i>
+*/
+template <typename T>
+T parameter_value(const command_line& cl, const string& name, const T dflt)
+  { return (cl.value_present(name) ? from_string<T>(cl.value(name)) : dflt); }
+
+int main(int argc, char** argv)
+{ const command_line cl(argc, argv);
+
+  if (!cl.value_present("-dir"s))
+  { cerr << "ERROR: no output directory given" << endl;
+    return -1;
+  }
+
+  const string dirname          { cl.value("-dir"s) };
+  const string start            { parameter_value(cl, "-start"s, "2022-10-29"s) };
+  const int    hours            { parameter_value(cl, "-hrs"s, 24) };
+  const int    n_entrants       { parameter_value(cl, "-entrants"s, 500) };
+  const int    n_others         { parameter_value(cl, "-others"s, 4000) };
+  const double rate             { parameter_value(cl, "-rate"s, 60.0) };
+  const double run_fraction     { parameter_value(cl, "-run"s, 0.5) };
+  const double bust_rate        { parameter_value(cl, "-bust"s, 0.02) };
+  const int    max_clock_skew   { parameter_value(cl, "-skew"s, 1) };
+  const int    max_freq_skew    { parameter_value(cl, "-fskew"s, 1) };
+  const double nofreq_fraction  { parameter_value(cl, "-nofreq"s, 0.05) };
+  const int    seed             { parameter_value(cl, "-seed"s, 1) };
+
+  if ( (hours <= 0) or (n_entrants <= 0) or (n_others <= 0) or (rate <= 0) )
+  { cerr << "ERROR: -hrs, -entrants, -others and -rate must be positive" << endl;
+    return -1;
+  }
+
+  tm start_tm { };
+
+  { istringstream iss { start };
+
+    iss >> get_time(&start_tm, (start.find('T') == string::npos) ? "%Y-%m-%d" : "%Y-%m-%dT%H:%M");
+
+    if (iss.fail())
+    { cerr << "ERROR: invalid start time: " << start << endl;
+      return -1;
+    }
+  }
+
+  const time_t t_start   { timegm(&start_tm) };
+  const int    n_minutes { hours * 60 };
+
+  mt19937_64                    rng { static_cast<uint64_t>(seed) };
+  uniform_real_distribution<>   unit_dist { 0, 1 };
+  uniform_int_distribution<int> zone_dist { 1, 40 };
+  uniform_int_distribution<int> offset_dist { 1, BAND_WIDTH };
+
+// the stations: first the entrants, then the others
+  vector<station> stations;
+  set<string>     used_calls;
+
+  while (ssize(stations) < n_entrants + n_others)
+  { string call { random_call(rng) };
+
+    if (!used_calls.insert(call).second)
+      continue;
+
+    station stn;
+
+    stn.call = move(call);
+    stn.entrant = (ssize(stations) < n_entrants);
+    stn.runner = !stn.entrant and (unit_dist(rng) < 0.05);
+    stn.zone = zone_dist(rng);
+
+    if (stn.entrant)
+    { if (unit_dist(rng) < 0.2)
+        stn.clock_skew = uniform_int_distribution<int> { -max_clock_skew, max_clock_skew }(rng);
+
+      if (unit_dist(rng) < 0.1)
+        stn.freq_skew = uniform_int_distribution<int> { -max_freq_skew, max_freq_skew }(rng);
+
+      stn.no_freq_info = (unit_dist(rng) < nofreq_fraction);
+    }
+
+    for (int b { 0 }; b < N_BANDS; ++b)
+      stn.run_qrg[b] = BAND_EDGE[b] + offset_dist(rng);
+
+    stations += move(stn);
+  }
+
+  vector<size_t> other_runners;                          // the stations that do not submit a log but run
+
+  for (size_t n = n_entrants; n < stations.size(); ++n)
+    if (stations[n].runner)
+      other_runners += n;
+
+// a few stations that do not submit logs are worked very often, most only a few times
+  auto random_other = [&] (void) { const double u { unit_dist(rng) };
+                                   return static_cast<size_t>(n_entrants + static_cast<int>(n_others * u * u * u));
+                                 };
+
+  discrete_distribution<int> band_dist { BAND_WEIGHT.begin(), BAND_WEIGHT.end() };
+
+// add a QSO to the log of a station, as recorded by that station
+  auto log_qso = [&] (station& logger, const int band, const int qrg, const int minute, const station& other)
+    { const int logged_minute { clamp(minute + logger.clock_skew, 0, n_minutes - 1) };
+      const int logged_qrg    { logger.no_freq_info ? BAND_EDGE[band] : (qrg + logger.freq_skew) };
+      const string copied     { (unit_dist(rng) < bust_rate) ? bust(other.call, rng) : other.call };
+
+      const time_t t { t_start + logged_minute * 60 };
+      tm           qso_tm;
+
+      gmtime_r(&t, &qso_tm);
+
+      ostringstream ost;
+
+      ost << "QSO: " << setw(5) << logged_qrg << " CW " << put_time(&qso_tm, "%Y-%m-%d %H%M") << " "
+          << left << setw(13) << logger.call << " 599 " << setw(2) << setfill('0') << right << logger.zone << setfill(' ') << " "
+          << left << setw(13) << copied << " 599 " << setw(2) << setfill('0') << right << other.zone << setfill(' ');
+
+      logger.log_lines.emplace_back(logged_minute, ost.str());
+    };
+
+  const int n_blocks { (n_minutes + BLOCK_MINUTES - 1) / BLOCK_MINUTES };
+
+  for (int block { 0 }; block < n_blocks; ++block)
+  { const int first_minute   { block * BLOCK_MINUTES };
+    const int minutes_in_block { min(BLOCK_MINUTES, n_minutes - first_minute) };
+
+    uniform_int_distribution<int> minute_dist { first_minute, first_minute + minutes_in_block - 1 };
+
+// decide what each entrant does in this block
+    vector<int>                         band(n_entrants, -1);           // -1 => off the air
+    vector<bool>                        running(n_entrants, false);
+    array<vector<size_t>, N_BANDS>      band_runners;                   // the stations running on each band
+
+    for (int e { 0 }; e < n_entrants; ++e)
+    { if (unit_dist(rng) < 0.2)
+        continue;
+
+      band[e] = band_dist(rng);
+      running[e] = (unit_dist(rng) < run_fraction);
+
+      if (running[e])
+        band_runners[band[e]] += static_cast<size_t>(e);
+    }
+
+    for (const size_t n : other_runners)
+      band_runners[band_dist(rng)] += n;
+
+    for (int e { 0 }; e < n_entrants; ++e)
+    { if (band[e] < 0)
+        continue;
+
+      const double expected_qsos { rate * minutes_in_block / 60 };
+      const int    n_qsos        { static_cast<int>(expected_qsos) + ((unit_dist(rng) < (expected_qsos - floor(expected_qsos))) ? 1 : 0) };
+
+      station& stn { stations[e] };
+
+      for (int q { 0 }; q < n_qsos; ++q)
+      { const int minute { minute_dist(rng) };
+
+        if (running[e])
+          log_qso(stn, band[e], stn.run_qrg[band[e]], minute, stations[random_other()]);
+        else
+        { const vector<size_t>& runners { band_runners[band[e]] };
+
+          if (runners.empty())
+            continue;
+
+          station& runner { stations[runners[uniform_int_distribution<size_t> { 0, runners.size() - 1 }(rng)]] };
+          const int qrg { runner.run_qrg[band[e]] };
+
+          log_qso(stn, band[e], qrg, minute, runner);
+
+          if (runner.entrant)
+            log_qso(runner, band[e], qrg, minute, stn);
+        }
+      }
+    }
+  }
+
+  filesystem::create_directories(dirname);
+
+  for (int e { 0 }; e < n_entrants; ++e)
+  { station& stn { stations[e] };
+
+    stable_sort(stn.log_lines.begin(), stn.log_lines.end(), [] (const auto& pr1, const auto& pr2) { return (pr1.first < pr2.first); });
+
+    string filename { to_lower(stn.call) };
+
+    replace(filename.begin(), filename.end(), '/', '-');
+
+    ofstream ofs { dirname + "/"s + filename + ".log"s };
+
+    ofs << "START-OF-LOG: 3.0" << '\n'
+        << "CALLSIGN: " << stn.call << '\n'
+        << "CONTEST: DRSCP-SYNTHETIC" << '\n';
+
+    FOR_ALL(stn.log_lines, [&ofs] (const auto& pr) { ofs << pr.second << '\n'; });
+
+    ofs << "END-OF-LOG:" << '\n';
+
+    if (!ofs)
+    { cerr << "ERROR: unable to write log: " << filename << endl;
+      return -1;
+    }
+  }
+
+  cout << dirname << " " << start << " " << hours << endl;
+
+  return 0;
+}
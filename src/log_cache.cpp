@@ -0,0 +1,392 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   log_cache.cpp
+
+    Functions to write and read files that cache the logs of a contest, so that the logs need not be parsed again,
+    and files that cache the calls derived from them, so that an unchanged contest need not be processed again
+
+    A cache file of logs contains, in order (each array aligned on an eight-byte boundary):
+      the magic string LOG_CACHE_MAGIC;
+      the key;
+      the calls, in order of identifier: the end offset of each, then their characters;
+      the number of lines rejected for each reason, and the number of QSO lines;
+      the groups, as columns: log index, tcall and end;
+      the QSOs, as columns: time, relative minutes, frequency, rcall and identifier;
+      the magic string again.
+    The tcall and band of each QSO are not stored, since they follow from its group and frequency.
+
+    A cache file of calls contains the magic string CALL_MAP_CACHE_MAGIC; the key; the calls, as written by put_calls();
+    and the magic string again.
+*/
+
+#include "binary_io.h"
+#include "diskfile.h"
+#include "log_cache.h"
+#include "scp_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+constexpr string_view LOG_CACHE_MAGIC      { "DRSCPLC1"sv };    ///< identifies a cache file of logs, and the version of its format
+constexpr string_view CALL_MAP_CACHE_MAGIC { "DRSCPCM1"sv };    ///< identifies a cache file of calls, and the version of its format
+
+/*! \brief                  Obtain the name of a cache file for a contest directory
+    \param  cache_dirname   directory that holds the cache files
+    \param  dirname         directory that contains the logs
+    \param  suffix          suffix that identifies the contents of the file
+    \return                 name of the cache file for <i>dirname</i>
+*/
+string cache_filename(const string& cache_dirname, const string& dirname, const string_view suffix)
+{ string   readable_name;
+  uint64_t hash { 0xcbf29ce484222325 };         // FNV-1a, so that names that differ only in punctuation do not collide
+
+  for (const char c : dirname)
+  { readable_name += (isalnum(static_cast<unsigned char>(c)) ? c : '_');
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+  }
+
+  ostringstream ost;
+
+  ost << cache_dirname << "/" << readable_name << "-" << hex << setw(16) << setfill('0') << hash << suffix;
+
+  return ost.str();
+}
+
+/*! \brief                  Write a buffer to a file
+    \param  filename        name of the file
+    \param  bw              buffer to write
+    \return                 whether the file was written successfully
+
+    The file is written under a temporary name and then renamed, so a partially-written file is never read
+*/
+bool write_atomically(const string& filename, const binary_writer& bw)
+{ const string tmp_filename { filename + ".tmp"s };
+
+  { ofstream ofs { tmp_filename, ios::binary | ios::trunc };
+
+    if (!ofs.write(bw.buffer().data(), bw.buffer().size()))
+      return false;
+  }
+
+  try
+  { file_rename(tmp_filename, filename);
+  }
+
+  catch (...)
+  { return false;
+  }
+
+  return true;
+}
+
+/*! \brief                  Obtain the name of the cache file for a contest directory
+    \param  cache_dirname   directory that holds the cache files
+    \param  dirname         directory that contains the logs
+    \return                 name of the cache file for <i>dirname</i>
+*/
+string log_cache_filename(const string& cache_dirname, const string& dirname)
+  { return cache_filename(cache_dirname, dirname, ".logs"sv); }
+
+/*! \brief                  Obtain the name of the file that caches the calls derived from a contest directory
+    \param  cache_dirname   directory that holds the cache files
+    \param  dirname         directory that contains the logs
+    \param  parameters      short description of the parameters that affect the calls
+    \return                 name of the file that caches the calls for <i>dirname</i> and <i>parameters</i>
+
+    Each set of parameters has its own file, so that runs with different parameters do not displace one another's results
+*/
+string call_map_cache_filename(const string& cache_dirname, const string& dirname, const string& parameters)
+  { return cache_filename(cache_dirname, dirname, "."s + parameters + ".calls"s); }
+
+/*! \brief              Obtain the key that identifies the inputs from which the logs of a contest are read
+    \param  cp          directory, start and duration
+    \param  filenames   names of the files in the directory
+    \return             key comprising the contest period and the name, size and mtime of each file
+
+    A cache file may be used only if its key matches the current key
+*/
+string log_cache_key(const contest_parameters& cp, const vector<string>& filenames)
+{ ostringstream ost;
+
+  ost << "start " << cp.t_start() << " hours " << cp.hours() << "\n";
+
+  for (const string& filename : filenames)
+    ost << filename << "\t" << file_size(filename) << "\t" << mtime(filename) << "\n";
+
+  return ost.str();
+}
+
+/*! \brief                  Write logs to a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the inputs
+    \param  logs            the logs to write
+    \return                 whether the file was written successfully
+
+    The file is written under a temporary name and then renamed, so a partially-written file is never read
+*/
+bool write_log_cache(const string& cache_filename, const string& key, const contest_logs& logs)
+{ const call_table&        calls { logs.calls() };
+  const vector<small_qso>& qsos  { logs.qsos() };
+
+  binary_writer bw;
+
+  bw.put(LOG_CACHE_MAGIC);
+  bw.put<uint64_t>(key.size());
+  bw.put(key);
+  bw.align(8);
+
+// calls
+  vector<uint32_t> call_ends;
+  uint32_t         n_chars { 0 };
+
+  call_ends.reserve(calls.size());
+
+  for (CALL_ID id { 0 }; id < calls.size(); ++id)
+    call_ends += (n_chars += static_cast<uint32_t>(calls.call(id).size()));
+
+  bw.put<uint64_t>(calls.size());
+  bw.put(span<const uint32_t> { call_ends });
+  bw.align(8);
+
+  for (CALL_ID id { 0 }; id < calls.size(); ++id)
+    bw.put(string_view { calls.call(id) });
+
+  bw.align(8);
+
+// counts
+  bw.put(logs.rejects());
+  bw.put<int64_t>(logs.n_qso_lines());
+  bw.align(8);
+
+// groups
+  vector<uint32_t> group_logs;
+  vector<CALL_ID>  group_tcalls;
+  vector<uint32_t> group_ends;
+  uint32_t         n_qsos { 0 };
+
+  for (size_t g { 0 }; g < logs.n_groups(); ++g)
+  { group_logs += logs.group_log(g);
+    group_tcalls += logs.group_tcall(g);
+    group_ends += (n_qsos += static_cast<uint32_t>(logs.group_qsos(g).size()));
+  }
+
+  bw.put<uint64_t>(logs.n_groups());
+  bw.put(span<const uint32_t> { group_logs });
+  bw.align(8);
+  bw.put(span<const CALL_ID> { group_tcalls });
+  bw.align(8);
+  bw.put(span<const uint32_t> { group_ends });
+  bw.align(8);
+
+// QSOs
+  vector<int64_t> times;
+  vector<int32_t> rel_mins;
+  vector<int32_t> qrgs;
+  vector<CALL_ID> rcalls;
+  vector<int32_t> ids;
+
+  times.reserve(qsos.size());
+  rel_mins.reserve(qsos.size());
+  qrgs.reserve(qsos.size());
+  rcalls.reserve(qsos.size());
+  ids.reserve(qsos.size());
+
+  for (const small_qso& qso : qsos)
+  { times += static_cast<int64_t>(qso.time());
+    rel_mins += qso.rel_mins();
+    qrgs += qso.qrg();
+    rcalls += qso.rcall();
+    ids += qso.id();
+  }
+
+  bw.put<uint64_t>(qsos.size());
+  bw.put(span<const int64_t> { times });
+  bw.align(8);
+  bw.put(span<const int32_t> { rel_mins });
+  bw.align(8);
+  bw.put(span<const int32_t> { qrgs });
+  bw.align(8);
+  bw.put(span<const CALL_ID> { rcalls });
+  bw.align(8);
+  bw.put(span<const int32_t> { ids });
+  bw.align(8);
+
+  bw.put(LOG_CACHE_MAGIC);
+
+  return write_atomically(cache_filename, bw);
+}
+
+/*! \brief                  Read logs from a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the current inputs
+    \return                 the logs, if <i>cache_filename</i> exists, is well formed, and has the key <i>key</i>
+*/
+optional<contest_logs> read_log_cache(const string& cache_filename, const string& key)
+{ if (!file_exists(cache_filename))
+    return nullopt;
+
+  try
+  { memory_mapped_file cache_file { cache_filename };
+    binary_reader      br         { cache_file.contents() };
+
+    if ( (br.get_string(LOG_CACHE_MAGIC.size()) != LOG_CACHE_MAGIC) or (br.get_string(br.get<uint64_t>()) != key) )
+      return nullopt;
+
+    br.align(8);
+
+// calls
+    const uint64_t                n_calls   { br.get<uint64_t>() };
+    const span<const uint32_t>    call_ends { br.get_span<uint32_t>(n_calls) };
+
+    br.align(8);
+
+    const string_view call_chars { br.get_string(call_ends.empty() ? 0 : call_ends.back()) };
+
+    br.align(8);
+
+// counts
+    const auto    rejects     { br.get<array<int, static_cast<size_t>(QSO_REJECT::N_REASONS)>>() };
+    const int64_t n_qso_lines { br.get<int64_t>() };
+
+    br.align(8);
+
+// groups
+    const uint64_t             n_groups     { br.get<uint64_t>() };
+    const span<const uint32_t> group_logs   { br.get_span<uint32_t>(n_groups) };
+
+    br.align(8);
+
+    const span<const CALL_ID>  group_tcalls { br.get_span<CALL_ID>(n_groups) };
+
+    br.align(8);
+
+    const span<const uint32_t> group_ends   { br.get_span<uint32_t>(n_groups) };
+
+    br.align(8);
+
+// QSOs
+    const uint64_t            n_qsos   { br.get<uint64_t>() };
+    const span<const int64_t> times    { br.get_span<int64_t>(n_qsos) };
+
+    br.align(8);
+
+    const span<const int32_t> rel_mins { br.get_span<int32_t>(n_qsos) };
+
+    br.align(8);
+
+    const span<const int32_t> qrgs     { br.get_span<int32_t>(n_qsos) };
+
+    br.align(8);
+
+    const span<const CALL_ID> rcalls   { br.get_span<CALL_ID>(n_qsos) };
+
+    br.align(8);
+
+    const span<const int32_t> ids      { br.get_span<int32_t>(n_qsos) };
+
+    br.align(8);
+
+    if ( (br.get_string(LOG_CACHE_MAGIC.size()) != LOG_CACHE_MAGIC) or !br.good() or !br.at_end() )
+      return nullopt;
+
+// check that the contents are consistent before using them
+    const bool bad_calls  { !is_sorted(call_ends.begin(), call_ends.end()) };
+    const bool bad_groups { !is_sorted(group_ends.begin(), group_ends.end()) or (!group_ends.empty() and (group_ends.back() != n_qsos)) or
+                            ANY_OF(group_tcalls, [n_calls] (const CALL_ID tcall) { return (tcall >= n_calls); }) };
+    const bool bad_qsos   { ANY_OF(rcalls, [n_calls] (const CALL_ID rcall) { return (rcall >= n_calls); }) };
+
+    if (bad_calls or bad_groups or bad_qsos)
+      return nullopt;
+
+    contest_logs rv;
+
+    for (uint32_t id { 0 }, first { 0 }; id < n_calls; first = call_ends[id++])
+      if (rv.intern(call_chars.substr(first, call_ends[id] - first)) != id)     // a duplicated call
+        return nullopt;
+
+    rv.rejects(rejects);
+    rv.n_qso_lines(static_cast<int>(n_qso_lines));
+
+    vector<small_qso> qsos;
+
+    for (uint32_t g { 0 }, first { 0 }; g < n_groups; first = group_ends[g++])
+    { qsos.clear();
+
+      for (uint32_t n { first }; n < group_ends[g]; ++n)
+        qsos.emplace_back(group_tcalls[g], rcalls[n], qrgs[n], static_cast<time_t>(times[n]), rel_mins[n], ids[n]);
+
+      rv.add_group(group_logs[g], group_tcalls[g], qsos);
+    }
+
+    return rv;
+  }
+
+  catch (const diskfile_exception& e)
+  { return nullopt;
+  }
+}
+
+/*! \brief                  Write calls to a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the inputs and the parameters that affect the calls
+    \param  calls           the calls, with their counts
+    \return                 whether the file was written successfully
+
+    The file is written under a temporary name and then renamed, so a partially-written file is never read
+*/
+bool write_call_map_cache(const string& cache_filename, const string& key, const collated_calls& calls)
+{ binary_writer bw;
+
+  bw.put(CALL_MAP_CACHE_MAGIC);
+  bw.put<uint64_t>(key.size());
+  bw.put(key);
+  bw.align(8);
+
+  put_calls(bw, calls);
+  bw.put(CALL_MAP_CACHE_MAGIC);
+
+  return write_atomically(cache_filename, bw);
+}
+
+/*! \brief                  Read calls from a cache file
+    \param  cache_filename  name of the cache file
+    \param  key             key that identifies the current inputs and parameters
+    \return                 the calls, if <i>cache_filename</i> exists, is well formed, and has the key <i>key</i>
+*/
+optional<collated_calls> read_call_map_cache(const string& cache_filename, const string& key)
+{ if (!file_exists(cache_filename))
+    return nullopt;
+
+  try
+  { memory_mapped_file cache_file { cache_filename };
+    binary_reader      br         { cache_file.contents() };
+
+    if ( (br.get_string(CALL_MAP_CACHE_MAGIC.size()) != CALL_MAP_CACHE_MAGIC) or (br.get_string(br.get<uint64_t>()) != key) )
+      return nullopt;
+
+    br.align(8);
+
+    optional<collated_calls> rv { get_calls(br) };
+
+    if ( !rv or (br.get_string(CALL_MAP_CACHE_MAGIC.size()) != CALL_MAP_CACHE_MAGIC) or !br.good() or !br.at_end() )
+      return nullopt;
+
+    return rv;
+  }
+
+  catch (const diskfile_exception& e)
+  { return nullopt;
+  }
+}
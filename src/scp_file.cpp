@@ -0,0 +1,520 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   scp_file.cpp
+
+    Functions to generate the output files, in text SCP/XSCP and in binary XSCP format, and a class to read binary XSCP files.
+
+    A binary XSCP file contains, in order (each array aligned on an eight-byte boundary, all values in native byte order):
+      the magic string BINARY_XSCP_MAGIC, or INDEXED_XSCP_MAGIC if the file has a substring index;
+      the number of calls, and the total number of characters in the calls (each a uint64_t);
+      the end offset of each call in the characters (uint32_t);
+      the count of each call (int32_t);
+      the characters of the calls, without separators;
+      the prefix index: for each of the 256 collation bytes, the index of the first call whose first character has that byte
+        or a later one, then the number of calls (257 uint32_t values);
+      only if the file has a substring index:
+        the number of distinct trigrams in the calls, and the total number of postings (each a uint64_t);
+        the key of each trigram, in increasing order (uint32_t);
+        the end offset of the postings of each trigram (uint32_t);
+        the postings: for each trigram, the indices of the calls that contain it, in increasing order (uint32_t);
+      the magic string again.
+    Calls are in callsign order, so the calls that begin with a particular character, or string, are contiguous.
+    A trigram is three consecutive characters of a call; its key packs a six-bit code for each character (see trigram_key()).
+
+    A partial file contains, in order (each array aligned on an eight-byte boundary):
+      the magic string PARTIAL_MAGIC;
+      the parameters that affect the calls;
+      the number of directories, then the length and characters of the name of each;
+      the calls, as written by put_calls();
+      the magic string again.
+*/
+
+#include "binary_io.h"
+#include "scp_file.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+
+using namespace std;
+
+constexpr string_view BINARY_XSCP_MAGIC  { "DRSCPXB1"sv };   ///< identifies a binary XSCP file, and the version of its format
+constexpr string_view INDEXED_XSCP_MAGIC { "DRSCPXB2"sv };   ///< identifies a binary XSCP file with a substring index
+
+constexpr string_view PARTIAL_MAGIC     { "DRSCPPT1"sv };    ///< identifies a partial file, and the version of its format
+
+constexpr size_t PREFIX_INDEX_SIZE { 257 };                 ///< number of entries in the prefix index
+constexpr size_t TRIGRAM_LENGTH    { 3 };                   ///< number of characters in a trigram
+
+/// the code of each character in a trigram key: 1 to 37 for the characters of CALLSIGN_CHARS, and 63 for every other character
+constexpr array<uint32_t, 256> TRIGRAM_CHAR_CODE { [] (void)
+  { array<uint32_t, 256> rv { };
+    uint32_t             code { 1 };
+
+    rv.fill(63);
+
+    for (const char c : "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ/"sv)
+      rv[static_cast<unsigned char>(c)] = code++;
+
+    return rv;
+  } () };
+
+/*! \brief          Obtain the key of the trigram at the start of a string
+    \param  str     string of at least TRIGRAM_LENGTH characters
+    \return         the key of the first TRIGRAM_LENGTH characters of <i>str</i>
+
+    Characters that are not in CALLSIGN_CHARS share a code, so a key may stand for more than one trigram;
+    the calls found from the postings are therefore always tested for the string
+*/
+inline uint32_t trigram_key(const string_view str)
+  { return ( (TRIGRAM_CHAR_CODE[static_cast<unsigned char>(str[0])] << 12) |
+             (TRIGRAM_CHAR_CODE[static_cast<unsigned char>(str[1])] << 6) |
+              TRIGRAM_CHAR_CODE[static_cast<unsigned char>(str[2])] );
+  }
+
+/*! \brief          Obtain the collation byte of the first character of a string
+    \param  str     non-empty string
+    \return         the collation byte of the first character of <i>str</i>
+*/
+inline unsigned char first_collation_byte(const string_view str)
+  { return static_cast<unsigned char>(call_collation_key(str.substr(0, 1))[0]); }
+
+/*! \brief              Generate the text of an SCP or XSCP file
+    \param  calls       the calls, with their counts
+    \param  val_limit   the least count of a call to be included
+    \param  xscp        whether to generate XSCP output, which includes the count on each line
+    \return             the contents of the file, one call per line, in callsign order
+
+    The text is built in a single buffer, so that it can be written at once
+*/
+string scp_text(const collated_calls& calls, const int val_limit, const bool xscp)
+{ string rv;
+
+  rv.reserve(calls.size() * (xscp ? 16 : 8));
+
+  calls.for_each_call([&rv, val_limit, xscp] (const string& call, const int count)
+    { if (count >= val_limit)
+      { rv += call;
+
+        if (xscp)
+        { rv += ' ';
+          rv += to_string(count);
+        }
+
+        rv += '\n';
+      }
+    });
+
+  return rv;
+}
+
+/*! \brief                  Generate the contents of a binary XSCP file
+    \param  calls           the calls, with their counts
+    \param  val_limit       the least count of a call to be included
+    \param  substring_index whether to include the trigram index, with which the calls that contain a string are found quickly
+    \return                 the contents of the file
+*/
+string binary_xscp(const collated_calls& calls, const int val_limit, const bool substring_index)
+{ vector<string>   included_calls;
+  vector<uint32_t> call_ends;
+  vector<int32_t>  counts;
+  uint32_t         n_chars { 0 };
+
+  calls.for_each_call([&] (const string& call, const int count)
+    { if (count >= val_limit)
+      { call_ends += (n_chars += static_cast<uint32_t>(call.size()));
+        counts += count;
+        included_calls += call;
+      }
+    });
+
+// the calls are in callsign order, so the collation bytes of their first characters are too
+  vector<uint32_t> first_index(PREFIX_INDEX_SIZE, 0);
+
+  for (size_t b { 0 }, n { 0 }; b < PREFIX_INDEX_SIZE - 1; ++b)
+  { while ( (n < included_calls.size()) and (first_collation_byte(included_calls[n]) < b) )
+      n++;
+
+    first_index[b] = static_cast<uint32_t>(n);
+  }
+
+  first_index[PREFIX_INDEX_SIZE - 1] = static_cast<uint32_t>(included_calls.size());
+
+  const string_view magic { substring_index ? INDEXED_XSCP_MAGIC : BINARY_XSCP_MAGIC };
+
+  binary_writer bw;
+
+  bw.put(magic);
+  bw.put<uint64_t>(included_calls.size());
+  bw.put<uint64_t>(n_chars);
+  bw.put(span<const uint32_t> { call_ends });
+  bw.align(8);
+  bw.put(span<const int32_t> { counts });
+  bw.align(8);
+  FOR_ALL(included_calls, [&bw] (const string& call) { bw.put(string_view { call }); });
+  bw.align(8);
+  bw.put(span<const uint32_t> { first_index });
+  bw.align(8);
+
+  if (substring_index)
+  { vector<pair<uint32_t /* trigram key */, uint32_t /* call index */>> entries;    // each distinct trigram of each call
+
+    for (uint32_t n { 0 }; n < included_calls.size(); ++n)
+    { const string_view call        { included_calls[n] };
+      const auto        first_entry { ssize(entries) };
+
+      for (size_t posn { 0 }; posn + TRIGRAM_LENGTH <= call.size(); ++posn)
+        entries.emplace_back(trigram_key(call.substr(posn)), n);
+
+      sort(entries.begin() + first_entry, entries.end());                           // a call might contain a trigram more than once
+      entries.erase(unique(entries.begin() + first_entry, entries.end()), entries.end());
+    }
+
+    SORT(entries);                                                                  // by trigram, then by call
+
+    vector<uint32_t> trigram_keys;
+    vector<uint32_t> posting_ends;
+    vector<uint32_t> postings;
+
+    postings.reserve(entries.size());
+
+    for (const auto& [ key, n ] : entries)
+    { if (trigram_keys.empty() or (key != trigram_keys.back()))
+      { if (!trigram_keys.empty())
+          posting_ends += static_cast<uint32_t>(postings.size());
+
+        trigram_keys += key;
+      }
+
+      postings += n;
+    }
+
+    if (!trigram_keys.empty())
+      posting_ends += static_cast<uint32_t>(postings.size());
+
+    bw.put<uint64_t>(trigram_keys.size());
+    bw.put<uint64_t>(postings.size());
+    bw.put(span<const uint32_t> { trigram_keys });
+    bw.align(8);
+    bw.put(span<const uint32_t> { posting_ends });
+    bw.align(8);
+    bw.put(span<const uint32_t> { postings });
+    bw.align(8);
+  }
+
+  bw.put(magic);
+
+  return bw.buffer();
+}
+
+/*! \brief          Append calls and their counts to a buffer
+    \param  bw      buffer to which the calls are appended
+    \param  calls   the calls, with their counts
+
+    The calls are written as their number; the end offset of each in the characters; the characters; and the count of each.
+    The calls begin and end on an eight-byte boundary
+*/
+void put_calls(binary_writer& bw, const collated_calls& calls)
+{ vector<uint32_t> call_ends;
+  vector<int32_t>  counts;
+  uint32_t         n_chars { 0 };
+
+  call_ends.reserve(calls.size());
+  counts.reserve(calls.size());
+
+  for (const auto& [ key, count ] : calls.entries())
+  { call_ends += (n_chars += static_cast<uint32_t>(key.size()));
+    counts += count;
+  }
+
+  bw.put<uint64_t>(calls.size());
+  bw.put(span<const uint32_t> { call_ends });
+  bw.align(8);
+
+  calls.for_each_call([&bw] (const string& call, const int) { bw.put(string_view { call }); });
+
+  bw.align(8);
+  bw.put(span<const int32_t> { counts });
+  bw.align(8);
+}
+
+/*! \brief          Read calls and their counts from a buffer
+    \param  br      buffer from which the calls are read, positioned as after put_calls() (that is, on an eight-byte boundary)
+    \return         the calls, if they are well formed
+*/
+optional<collated_calls> get_calls(binary_reader& br)
+{ const uint64_t             n_calls   { br.get<uint64_t>() };
+  const span<const uint32_t> call_ends { br.get_span<uint32_t>(n_calls) };
+
+  br.align(8);
+
+  const string_view call_chars { br.get_string(call_ends.empty() ? 0 : call_ends.back()) };
+
+  br.align(8);
+
+  const span<const int32_t> counts { br.get_span<int32_t>(n_calls) };
+
+  br.align(8);
+
+  if (!br.good() or !is_sorted(call_ends.begin(), call_ends.end()))
+    return nullopt;
+
+  vector<pair<string, int>> calls_and_counts;
+
+  calls_and_counts.reserve(n_calls);
+
+  for (uint32_t n { 0 }, first { 0 }; n < n_calls; first = call_ends[n++])
+    calls_and_counts.emplace_back(call_chars.substr(first, call_ends[n] - first), counts[n]);
+
+  return collated_calls { calls_and_counts };
+}
+
+// -----------  binary_xscp_file  ----------------
+
+/*! \class  binary_xscp_file
+    \brief  A binary XSCP file, mapped into memory
+
+    The calls are in callsign order. Nothing is copied or parsed when the file is opened: calls are returned as views of the mapping.
+*/
+
+/*! \brief              Constructor
+    \param  filename    name of the file
+
+    Throws diskfile_exception if the file cannot be mapped or is not a well-formed binary XSCP file
+*/
+binary_xscp_file::binary_xscp_file(const string& filename) :
+  _file(filename)
+{ binary_reader br { _file.contents() };
+
+  const string_view magic { br.get_string(BINARY_XSCP_MAGIC.size()) };
+
+  if ( (magic != BINARY_XSCP_MAGIC) and (magic != INDEXED_XSCP_MAGIC) )
+    throw diskfile_exception("Not a binary XSCP file: "s + filename);
+
+  _indexed = (magic == INDEXED_XSCP_MAGIC);
+
+  const uint64_t n_calls { br.get<uint64_t>() };
+  const uint64_t n_chars { br.get<uint64_t>() };
+
+  _call_ends = br.get_span<uint32_t>(n_calls);
+  br.align(8);
+  _counts = br.get_span<int32_t>(n_calls);
+  br.align(8);
+  _call_chars = br.get_string(n_chars);
+  br.align(8);
+  _first_index = br.get_span<uint32_t>(PREFIX_INDEX_SIZE);
+  br.align(8);
+
+  uint64_t n_postings { 0 };
+
+  if (_indexed)
+  { const uint64_t n_trigrams { br.get<uint64_t>() };
+
+    n_postings = br.get<uint64_t>();
+
+    _trigram_keys = br.get_span<uint32_t>(n_trigrams);
+    br.align(8);
+    _posting_ends = br.get_span<uint32_t>(n_trigrams);
+    br.align(8);
+    _postings = br.get_span<uint32_t>(n_postings);
+    br.align(8);
+  }
+
+  const bool well_formed { (br.get_string(magic.size()) == magic) and br.good() and br.at_end() and
+                           is_sorted(_call_ends.begin(), _call_ends.end()) and (_call_ends.empty() ? (n_chars == 0) : (_call_ends.back() == n_chars)) and
+                           is_sorted(_first_index.begin(), _first_index.end()) and (_first_index.back() == n_calls) and
+                           (adjacent_find(_trigram_keys.begin(), _trigram_keys.end(), greater_equal<uint32_t> { }) == _trigram_keys.end()) and
+                           is_sorted(_posting_ends.begin(), _posting_ends.end()) and (_posting_ends.empty() ? (n_postings == 0) : (_posting_ends.back() == n_postings)) and
+                           ALL_OF(_postings, [n_calls] (const uint32_t n) { return (n < n_calls); }) };
+
+  if (!well_formed)
+    throw diskfile_exception("Malformed binary XSCP file: "s + filename);
+}
+
+/*! \brief          Obtain the calls that begin with a particular string
+    \param  prefix  the string
+    \return         the first index, and one past the last index, of the calls that begin with <i>prefix</i>
+
+    The prefix index gives the calls that begin with the first character of <i>prefix</i>; the rest are found by binary search
+*/
+pair<size_t, size_t> binary_xscp_file::calls_with_prefix(const string_view prefix) const
+{ if (prefix.empty())
+    return { 0, size() };
+
+  const unsigned char b          { first_collation_byte(prefix) };
+  const string        prefix_key { call_collation_key(prefix) };
+
+// compare only the first prefix.size() characters of each call
+  auto key_of = [this, &prefix] (const size_t n) { return call_collation_key(call(n).substr(0, prefix.size())); };
+
+  size_t lo { _first_index[b] };
+  size_t hi { _first_index[b + 1] };
+
+  while (lo < hi)                                   // first call whose leading characters are not before the prefix
+  { const size_t mid { lo + (hi - lo) / 2 };
+
+    if (key_of(mid) < prefix_key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  const size_t lower { lo };
+
+  hi = _first_index[b + 1];
+
+  while (lo < hi)                                   // first call whose leading characters are after the prefix
+  { const size_t mid { lo + (hi - lo) / 2 };
+
+    if (key_of(mid) == prefix_key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return { lower, lo };
+}
+
+/*! \brief          Obtain the count of a particular call
+    \param  target  call to find
+    \return         the count of <i>target</i>, if it is present
+*/
+optional<int> binary_xscp_file::find(const string_view target) const
+{ const auto [ lower, upper ] { calls_with_prefix(target) };
+
+  if ( (lower != upper) and (call(lower) == target) )       // a call precedes all the longer calls that begin with it
+    return count(lower);
+
+  return nullopt;
+}
+
+/*! \brief          Obtain the calls that contain a particular trigram
+    \param  key     key of the trigram
+    \return         the indices of the calls that contain the trigram whose key is <i>key</i>, in increasing order
+*/
+span<const uint32_t> binary_xscp_file::_trigram_postings(const uint32_t key) const
+{ const auto it { lower_bound(_trigram_keys.begin(), _trigram_keys.end(), key) };
+
+  if ( (it == _trigram_keys.end()) or (*it != key) )
+    return { };
+
+  const size_t   n     { static_cast<size_t>(it - _trigram_keys.begin()) };
+  const uint32_t first { (n == 0) ? 0 : _posting_ends[n - 1] };
+
+  return _postings.subspan(first, _posting_ends[n] - first);
+}
+
+/*! \brief              Obtain the calls that contain a particular string
+    \param  fragment    the string
+    \param  order       the order of the returned calls
+    \return             the indices of the calls that contain <i>fragment</i>, in the order <i>order</i>
+
+    With a substring index, only the calls that contain the rarest trigram of <i>fragment</i> are examined
+*/
+vector<size_t> binary_xscp_file::calls_containing(const string_view fragment, const XSCP_ORDER order) const
+{ vector<size_t> rv;
+
+  auto contains_fragment = [this, fragment] (const size_t n) { return (call(n).find(fragment) != string_view::npos); };
+
+  if (!_indexed or (fragment.size() < TRIGRAM_LENGTH))          // every call is examined
+  { for (size_t n { 0 }; n < size(); ++n)
+      if (contains_fragment(n))
+        rv += n;
+  }
+  else
+  { span<const uint32_t> candidates { _trigram_postings(trigram_key(fragment)) };
+
+    for (size_t posn { 1 }; !candidates.empty() and (posn + TRIGRAM_LENGTH <= fragment.size()); ++posn)
+      if (const span<const uint32_t> postings { _trigram_postings(trigram_key(fragment.substr(posn))) }; postings.size() < candidates.size())
+        candidates = postings;
+
+    for (const uint32_t n : candidates)
+      if (contains_fragment(n))
+        rv += n;
+  }
+
+  if (order == XSCP_ORDER::COUNT)
+    stable_sort(rv.begin(), rv.end(), [this] (const size_t n1, const size_t n2) { return (count(n1) > count(n2)); });
+
+  return rv;
+}
+
+// -----------  partial_calls  ----------------
+
+/*! \class  partial_calls
+    \brief  The calls from some of the contests in a list, to be merged with the calls from the others
+
+    Different subsets of the contests may be processed on different machines; merging the partial files
+    gives the same calls as processing all the contests at once
+*/
+
+/*! \brief                  Constructor
+    \param  parameters      the parameters that affect the calls
+    \param  directories     the directories of the contests
+    \param  calls           the calls from the contests, with their counts
+*/
+partial_calls::partial_calls(const string& parameters, const vector<string>& directories, collated_calls&& calls) :
+  _parameters(parameters),
+  _directories(directories),
+  _calls(move(calls))
+{ }
+
+/*! \brief              Constructor from a file
+    \param  filename    name of the file
+
+    Throws diskfile_exception if the file cannot be mapped or is not a well-formed partial file
+*/
+partial_calls::partial_calls(const string& filename)
+{ memory_mapped_file file { filename };
+  binary_reader      br   { file.contents() };
+
+  if (br.get_string(PARTIAL_MAGIC.size()) != PARTIAL_MAGIC)
+    throw diskfile_exception("Not a partial file: "s + filename);
+
+  _parameters = br.get_string(br.get<uint64_t>());
+  br.align(8);
+
+  const uint64_t n_directories { br.get<uint64_t>() };
+
+  for (uint64_t n { 0 }; (n < n_directories) and br.good(); ++n)
+  { _directories += string { br.get_string(br.get<uint64_t>()) };
+    br.align(8);
+  }
+
+  optional<collated_calls> calls { br.good() ? get_calls(br) : nullopt };
+
+  if (!calls or (br.get_string(PARTIAL_MAGIC.size()) != PARTIAL_MAGIC) or !br.good() or !br.at_end())
+    throw diskfile_exception("Malformed partial file: "s + filename);
+
+  _calls = move(calls.value());
+}
+
+/// the contents of a partial file that holds the object
+string partial_calls::contents(void) const
+{ binary_writer bw;
+
+  bw.put(PARTIAL_MAGIC);
+  bw.put<uint64_t>(_parameters.size());
+  bw.put(string_view { _parameters });
+  bw.align(8);
+  bw.put<uint64_t>(_directories.size());
+
+  for (const string& directory : _directories)
+  { bw.put<uint64_t>(directory.size());
+    bw.put(string_view { directory });
+    bw.align(8);
+  }
+
+  put_calls(bw, _calls);
+  bw.put(PARTIAL_MAGIC);
+
+  return bw.buffer();
+}
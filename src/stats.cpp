@@ -0,0 +1,152 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   stats.cpp
+
+    Classes for recording the time taken by, and the numbers of QSOs processed in, each stage of the processing
+*/
+
+#include "stats.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include <time.h>
+
+using namespace std;
+using namespace std::chrono;
+
+/*! \brief  Obtain the CPU time used so far by the calling thread
+    \return the CPU time used by the calling thread, in nanoseconds
+*/
+int64_t thread_cpu_ns(void)
+{ timespec ts;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+  return (static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec);
+}
+
+/*! \brief          Quote a string for inclusion in a CSV file
+    \param  str     string to quote
+    \return         <i>str</i> within double quotes, with any double quotes doubled
+*/
+string csv_quoted(const string& str)
+{ string rv { "\"" };
+
+  for (const char c : str)
+  { if (c == '"')
+      rv += '"';
+
+    rv += c;
+  }
+
+  return (rv + "\"");
+}
+
+// -----------  stats_recorder  ----------------
+
+/*! \class  stats_recorder
+    \brief  Thread-safe accumulator of the statistics of stages
+
+    When disabled, nothing is recorded
+*/
+
+/*! \brief      Add the statistics of a stage
+    \param  ss  the statistics
+*/
+void stats_recorder::operator+=(stage_stats&& ss)
+{ lock_guard lock { _mtx };
+
+  _stages += move(ss);
+}
+
+/*! \brief              Obtain the total CPU time of the stages of a directory that have been recorded
+    \param  directory   directory of the contest
+    \return             the sum of the CPU times of the stages of <i>directory</i>, in seconds
+*/
+double stats_recorder::cpu_secs(const string& directory) const
+{ lock_guard lock { _mtx };
+
+  double rv { 0 };
+
+  for (const stage_stats& ss : _stages)
+    if (ss.directory() == directory)
+      rv += ss.cpu_secs();
+
+  return rv;
+}
+
+/*! \brief  Obtain all the statistics, in CSV format
+    \return the statistics, one stage per line, after a header line
+*/
+string stats_recorder::csv(void) const
+{ lock_guard lock { _mtx };
+
+  ostringstream ost;
+
+  ost << "directory,band,stage,wall_secs,cpu_secs,qsos,removed" << '\n' << fixed << setprecision(6);
+
+  for (const stage_stats& ss : _stages)
+    ost << csv_quoted(ss.directory()) << ',' << ss.band() << ',' << ss.stage() << ',' << ss.wall_secs() << ',' << ss.cpu_secs() << ','
+        << ss.n_qsos() << ',' << ss.n_removed() << '\n';
+
+  return ost.str();
+}
+
+// -----------  stage_timer  ----------------
+
+/*! \class  stage_timer
+    \brief  Measure the elapsed and CPU time of a stage
+
+    A stage that runs entirely on one thread is timed from construction (or restart()) to record(). A stage that
+    submits tasks to a thread pool is marked as parallel, because a thread that waits for a task may meanwhile run
+    unrelated tasks; the CPU time of such a stage is the sum of the CPU time of the functions run through charge().
+*/
+
+/*! \brief              Constructor
+    \param  recorder    where the statistics are recorded; if it is disabled, the timer does nothing
+    \param  parallel    whether the stage runs on more than one thread
+*/
+stage_timer::stage_timer(stats_recorder& recorder, const bool parallel) :
+  _recorder(recorder),
+  _parallel(parallel)
+{ restart();
+}
+
+/// start timing a new stage
+void stage_timer::restart(void)
+{ if (!_recorder.enabled())
+    return;
+
+  _wall_start = steady_clock::now();
+  _cpu_start = (_parallel ? 0 : thread_cpu_ns());
+  _charged_cpu = 0;
+}
+
+/// the elapsed time since the stage started, in seconds
+double stage_timer::wall_secs(void) const
+  { return duration<double>(steady_clock::now() - _wall_start).count(); }
+
+/*! \brief              Record the statistics of the stage
+    \param  directory   directory of the contest
+    \param  band        band; empty if the stage is not performed per band
+    \param  stage       name of the stage
+    \param  n_qsos      number of QSOs processed by the stage
+    \param  n_removed   number of QSOs removed by the stage
+*/
+void stage_timer::record(const string& directory, const string& band, const string& stage, const int64_t n_qsos, const int64_t n_removed)
+{ if (!_recorder.enabled())
+    return;
+
+  const int64_t cpu_ns { _charged_cpu + (_parallel ? 0 : (thread_cpu_ns() - _cpu_start)) };
+
+  _recorder += stage_stats { directory, band, stage, wall_secs(), cpu_ns / 1e9, n_qsos, n_removed };
+}
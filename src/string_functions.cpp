@@ -16,6 +16,7 @@
 #include "macros.h"
 #include "string_functions.h"
 
+#include <array>
 #include <cctype>
 #include <cstdio>
 #include <iomanip>
@@ -893,6 +894,66 @@ bool compare_calls(const string& call1, const string& call2)
   return (l1 < l2);
 }
 
+/// the characters of calls, in callsign sort order; '-' is placed after '/', with which compare_calls treats it as equivalent
+constexpr string_view CALLSIGN_COLLATION_ORDER { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz1234567890/-"sv };
+
+/// the collation byte of each character: the characters of calls in callsign sort order from 1; then all other characters, in ordinary order
+constexpr array<unsigned char, 256> CALL_COLLATION_TABLE { [] (void)
+  { array<unsigned char, 256> rv { };
+    array<bool, 256>          placed { };
+    unsigned int              next_byte { 1 };
+
+    for (const char c : CALLSIGN_COLLATION_ORDER)
+    { rv[static_cast<unsigned char>(c)] = static_cast<unsigned char>(next_byte++);
+      placed[static_cast<unsigned char>(c)] = true;
+    }
+
+    for (unsigned int c { 1 }; c < 256; ++c)
+      if (!placed[c])
+        rv[c] = static_cast<unsigned char>(next_byte++);
+
+    return rv;                                          // '\0' maps to itself
+  } () };
+
+/// the character corresponding to each collation byte
+constexpr array<char, 256> CALL_COLLATION_INVERSE { [] (void)
+  { array<char, 256> rv { };
+
+    for (unsigned int c { 0 }; c < 256; ++c)
+      rv[CALL_COLLATION_TABLE[c]] = static_cast<char>(c);
+
+    return rv;
+  } () };
+
+/*! \brief          Obtain the collation key of a call
+    \param  call    call
+    \return         key whose ordinary (byte by byte) comparison with the key of another call reproduces callsign sort order
+
+    The key has the same length as <i>call</i>; each character is translated through a fixed table. For calls
+    made from CALLSIGN_CHARS, <i>key(call1) < key(call2)</i> if and only if <i>compare_calls(call1, call2)</i>.
+*/
+string call_collation_key(const string_view call)
+{ string rv(call.size(), '\0');
+
+  for (size_t n { 0 }; n < call.size(); ++n)
+    rv[n] = static_cast<char>(CALL_COLLATION_TABLE[static_cast<unsigned char>(call[n])]);
+
+  return rv;
+}
+
+/*! \brief          Obtain a call from its collation key
+    \param  key     collation key
+    \return         the call whose collation key is <i>key</i>
+*/
+string call_from_collation_key(const string_view key)
+{ string rv(key.size(), '\0');
+
+  for (size_t n { 0 }; n < key.size(); ++n)
+    rv[n] = CALL_COLLATION_INVERSE[static_cast<unsigned char>(key[n])];
+
+  return rv;
+}
+
 /*! \brief          Is the value of one mult earlier than another?
     \param  mult1   first mult value
     \param  mult2   second mult value
@@ -912,7 +973,7 @@ bool compare_mults(const string& mult1, const string& mult2)
 
     This should be faster than the find_next_of() or C++ is_letter or similar generic functions
 */
-bool contains_letter(const string& str)
+bool contains_letter(const string_view str)
 { for (const char& c : str)
     if ( (c >= 'A' and c <= 'Z') or (c >= 'a' and c <= 'z') )
       return true;
@@ -926,7 +987,7 @@ bool contains_letter(const string& str)
 
     This should be faster than the find_next_of() or C++ is_digit or similar generic functions
 */
-bool contains_digit(const string& str)
+bool contains_digit(const string_view str)
 { for (const char& c : str)
     if (c >= '0' and c <= '9')
       return true;
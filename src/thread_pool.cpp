@@ -0,0 +1,149 @@
+// $Id$
+
+// Released under the GNU Public License, version 2
+//   see: https://www.gnu.org/licenses/gpl-2.0.html
+
+// Principal author: N7DR
+
+// Copyright owners:
+//    N7DR
+
+/*! \file   thread_pool.cpp
+
+    A work-stealing pool of threads
+*/
+
+#include "thread_pool.h"
+
+using namespace std;
+
+namespace
+{
+
+thread_local const thread_pool* this_pool  { nullptr };  ///< the pool to which the current thread belongs; nullptr if none
+thread_local size_t             this_index { 0 };        ///< the index of the current thread in this_pool
+
+}
+
+// -----------  thread_pool  ----------------
+
+/*! \class  thread_pool
+    \brief  A fixed set of threads, each with its own queue of tasks, that steal work from one another when idle
+
+    A task submitted from one of the pool's threads goes onto that thread's own queue, and is taken
+    from the back (most recent first); a task submitted from elsewhere is distributed round robin.
+    An idle thread steals from the front of the other queues. A thread that waits for a result
+    (see wait()) runs queued tasks while it waits, so tasks may safely wait for the tasks that they submit.
+*/
+
+/*! \brief              Constructor
+    \param  n_threads   number of threads in the pool; if zero, one is used
+*/
+thread_pool::thread_pool(const unsigned int n_threads)
+{ const unsigned int n { max(n_threads, 1u) };
+
+  for (unsigned int index { 0 }; index < n; ++index)
+    _queues.emplace_back(make_unique<task_queue>());
+
+  for (unsigned int index { 0 }; index < n; ++index)
+    _threads.emplace_back(&thread_pool::_work, this, index);
+}
+
+/// destructor; runs any tasks still queued, then joins the threads
+thread_pool::~thread_pool(void)
+{ { lock_guard lock { _mtx };
+
+    _stopping = true;
+  }
+
+  _cv.notify_all();
+
+  for (auto& thr : _threads)
+    thr.join();
+}
+
+/*! \brief          Add a task to a queue
+    \param  task    task to add
+*/
+void thread_pool::_push(TASK&& task)
+{ const size_t index { (this_pool == this) ? this_index : (_next_queue++ % _queues.size()) };
+
+  { lock_guard lock { _mtx };
+
+    _n_queued++;                // count it first, so that the count is never less than the number of queued tasks
+  }
+
+  { lock_guard lock { _queues[index]->mtx };
+
+    _queues[index]->tasks.push_back(move(task));
+  }
+
+  _cv.notify_all();             // wake both idle threads and any thread that is waiting for a result; either may run the task
+}
+
+/*! \brief      Run one queued task, if there is one
+    \return     whether a task was run
+*/
+bool thread_pool::_run_one(void)
+{ const size_t n_queues { _queues.size() };
+  const size_t own      { (this_pool == this) ? this_index : 0 };
+
+  TASK task { };
+
+// try our own queue first, from the back; then steal from the front of the others
+  for (size_t offset { 0 }; !task and (offset < n_queues); ++offset)
+  { task_queue& q { *_queues[(own + offset) % n_queues] };
+
+    lock_guard lock { q.mtx };
+
+    if (!q.tasks.empty())
+    { if ( (offset == 0) and (this_pool == this) )
+      { task = move(q.tasks.back());
+        q.tasks.pop_back();
+      }
+      else
+      { task = move(q.tasks.front());
+        q.tasks.pop_front();
+      }
+    }
+  }
+
+  if (!task)
+    return false;
+
+  { lock_guard lock { _mtx };
+
+    _n_queued--;
+  }
+
+  task();
+
+  { lock_guard lock { _mtx };
+
+    _n_finished++;
+  }
+
+  _cv.notify_all();             // a thread may be waiting for this result
+
+  return true;
+}
+
+/*! \brief          Main loop of a thread
+    \param  index   index of the thread in the pool
+*/
+void thread_pool::_work(const size_t index)
+{ this_pool  = this;
+  this_index = index;
+
+  while (true)
+  { if (_run_one())
+      continue;
+
+    unique_lock lock { _mtx };
+
+    _cv.wait(lock, [this] (void) { return _stopping or (_n_queued != 0); });
+
+    if (_stopping and (_n_queued == 0))
+      return;
+  }
+}